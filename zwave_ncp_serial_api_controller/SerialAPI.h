@@ -343,6 +343,12 @@
 /* Specified but not yet implemented */
 #define FUNC_ID_SEND_NOP                                0xE9  // This define is never used (mentioned in the comment above)
 
+/* Serial API extensions of this NCP */
+#define FUNC_ID_SERIAL_API_BATCH                        0xEA
+#define FUNC_ID_SERIAL_API_COALESCED                    0xEB
+#define FUNC_ID_SERIAL_API_LINK_STATS                   0xEC
+#define FUNC_ID_SERIAL_API_LATENCY                      0xED
+
 /* Allocated for Power Management */
 #define FUNC_ID_SERIAL_API_POWER_MANAGEMENT             0xEE  // This define is never used
 #define FUNC_ID_SERIAL_API_READY                        0xEF  // This define is never used
@@ -27,10 +27,15 @@
 #include "app_node_info.h"
 #include "serialapi_file.h"
 #include "cmd_handlers.h"
+#include "tx_scheduler.h"
+#include "cmd_latency.h"
+#include "binlog.h"
 #include "cmds_management.h"
 #include "ZAF_Common_interface.h"
 #include "utils.h"
 #include "SerialAPI_hw.h"
+#include "serial_api_config.h"
+#include "zpal_uart_gpio.h"
 #include "zaf_event_distributor_ncp.h"
 #include "zpal_misc.h"
 #include "zpal_watchdog.h"
@@ -83,42 +88,39 @@ static uint8_t state = 0xff;
 static uint8_t retry = 0;
 
 static uint8_t lastRetVal = 0;      /* Used to store retVal for retransmissions */
-uint8_t compl_workbuf[BUF_SIZE_TX]; /* Used for frames send to remote side. */
-
-/* Queue for frames transmitted to PC - callback, ApplicationCommandHandler, ApplicationControllerUpdate... */
-#if !defined(MAX_CALLBACK_QUEUE)
-#define MAX_CALLBACK_QUEUE  8
-#endif /* !defined(MAX_CALLBACK_QUEUE) */
 
-#if !defined(MAX_UNSOLICITED_QUEUE)
-#define MAX_UNSOLICITED_QUEUE 8
-#endif /* !defined(MAX_UNSOLICITED_QUEUE) */
-
-typedef struct _callback_element_{
-  uint8_t wCmd;
-  uint8_t wLen;
-  uint8_t wBuf[BUF_SIZE_TX];
-} CALLBACK_ELEMENT;
+/* Set by RespondCaptureStart() while a batched sub-command runs */
+static uint8_t *pRespondCapture = NULL;
+static uint8_t respondCaptureSize;
+static uint8_t respondCaptureLength;
+static bool respondCaptured;
+uint8_t compl_workbuf[BUF_SIZE_TX]; /* Used for frames send to remote side. */
 
-typedef struct _request_queue_{
-  uint8_t requestOut;
-  uint8_t requestIn;
-  uint8_t requestCnt;
-  CALLBACK_ELEMENT requestQueue[MAX_CALLBACK_QUEUE];
-} REQUEST_QUEUE;
+/* Longest time an unsolicited frame may be held for others to join it */
+#if !defined(UNSOLICITED_COALESCE_HOLD_MAX_MS)
+#define UNSOLICITED_COALESCE_HOLD_MAX_MS  1000
+#endif
 
-REQUEST_QUEUE callbackQueue = { 0 };
+/* length | cmd ahead of each coalesced record */
+#define COALESCE_RECORD_HEADER  2
 
-typedef struct _request_unsolicited_queue_{
-  uint8_t requestOut;
-  uint8_t requestIn;
-  uint8_t requestCnt;
-  CALLBACK_ELEMENT requestQueue[MAX_UNSOLICITED_QUEUE];
-} REQUEST_UNSOLICITED_QUEUE;
+/* Unsolicited frames waiting to be sent as one FUNC_ID_SERIAL_API_COALESCED frame */
+static struct {
+  bool enabled;
+  uint16_t holdMs;
+  uint8_t records;
+  uint8_t length;
+  bool stuck;           // last flush failed, new records are refused until a flush succeeds
+  tx_class_t txClass;
+  SSwTimer holdTimer;
+  uint8_t buffer[BUF_SIZE_TX];
+} coalesce;
 
-REQUEST_UNSOLICITED_QUEUE commandQueue = { 0 };
+/* Slot of the REQUEST frame in flight in the legacy (non windowed) protocol */
+static uint8_t txSlot = TX_SCHEDULER_NONE;
 
 eSerialAPISetupNodeIdBaseType nodeIdBaseType = SERIAL_API_SETUP_NODEID_BASE_TYPE_DEFAULT;
+static uint32_t uartBaudRate = 0;  /* 0: default baud rate */
 
 #if SUPPORT_ZW_WATCHDOG_START | SUPPORT_ZW_WATCHDOG_STOP
 extern uint8_t bWatchdogStarted;
@@ -130,6 +132,8 @@ zpal_reset_reason_t g_eApplResetReason;
 SSwTimer mWakeupTimer;
 bool bTxStatusReportEnabled;
 
+app_link_stats_t appLinkStats;
+
 static void ApplicationInitSW(void);
 static void ApplicationTask(SApplicationHandles *pAppHandles);
 
@@ -176,43 +180,115 @@ void set_state(uint8_t st)
   state = st;
 }
 
-/*===============================   Request   ================================
-**    Queues request (callback) to be transmitted to remote side
+/*==============================   Enqueue   =================================
+**    Queues request to be transmitted to remote side in the given
+**    priority class
 **
 **--------------------------------------------------------------------------*/
-bool /*RET  queue status (false queue full)*/
-Request(
+static bool /*RET  queue status (false class full)*/
+Enqueue(
+  tx_class_t txClass,  /*IN   Priority class           */
   uint8_t cmd,         /*IN   Command                  */
   uint8_t *pData,   /*IN   pointer to data          */
   uint8_t len          /*IN   Length of data           */
   )
 {
-  // IF slot available in callback transmit queue
-  if (callbackQueue.requestCnt < MAX_CALLBACK_QUEUE) {
-    // Add to callback transmit queue
-    callbackQueue.requestCnt++;
-    callbackQueue.requestQueue[callbackQueue.requestIn].wCmd = cmd;
-    if (len > (uint8_t)BUF_SIZE_TX) {
-      assert((uint8_t)BUF_SIZE_TX >= len);
-      len = (uint8_t)BUF_SIZE_TX;
-    }
-    callbackQueue.requestQueue[callbackQueue.requestIn].wLen = len;
-    memcpy(&callbackQueue.requestQueue[callbackQueue.requestIn].wBuf[0], pData, len);
-    // Move queue input pointer to next slot
-    if (++callbackQueue.requestIn >= MAX_CALLBACK_QUEUE) {
-      callbackQueue.requestIn = 0;
-    }
+  if (tx_scheduler_enqueue(txClass, cmd, pData, len)) {
     xTaskNotify(g_AppTaskHandle,
                 1 << EAPPLICATIONEVENT_STATECHANGE,
                 eSetBits);
-
     return true;
   }
   return false;
 }
 
+/*===============================   Request   ================================
+**    Queues request (callback) to be transmitted to remote side
+**
+**--------------------------------------------------------------------------*/
+bool /*RET  queue status (false queue full)*/
+Request(
+  uint8_t cmd,         /*IN   Command                  */
+  uint8_t *pData,   /*IN   pointer to data          */
+  uint8_t len          /*IN   Length of data           */
+  )
+{
+  return Enqueue(TX_CLASS_CALLBACK, cmd, pData, len);
+}
+
+/*==============================   CoalesceFlush   ===========================
+**    Queue the coalesced records. A single record is queued as the plain
+**    frame it was requested as. If the scheduler is full the records are
+**    kept and CoalescePoll() tries again.
+**
+**--------------------------------------------------------------------------*/
+static bool /*RET  queue status (false queue full)*/
+CoalesceFlush(void)
+{
+  bool status = true;
+
+  TimerStop(&coalesce.holdTimer);
+  if (1 == coalesce.records) {
+    status = Enqueue(coalesce.txClass, coalesce.buffer[1], &coalesce.buffer[COALESCE_RECORD_HEADER], coalesce.buffer[0]);
+  } else if (coalesce.records) {
+    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: %d records, %d bytes\r\n", __FUNCTION__, coalesce.records, coalesce.length);
+    status = Enqueue(coalesce.txClass, FUNC_ID_SERIAL_API_COALESCED, coalesce.buffer, coalesce.length);
+  }
+  coalesce.stuck = !status;
+  if (status) {
+    coalesce.records = 0;
+    coalesce.length = 0;
+  }
+  return status;
+}
+
+/*===========================   CoalescePoll   ==============================
+**    Queue the coalesced records unless other frames keep the link busy.
+**    Records are held at most holdMs; a hold time of 0 only holds them while
+**    a frame is in flight. Records a flush failed to queue are retried at once.
+**
+**--------------------------------------------------------------------------*/
+static void
+CoalescePoll(void)
+{
+  if (coalesce.records && (coalesce.stuck || (0 == coalesce.holdMs) || !tx_scheduler_pending())) {
+    CoalesceFlush();
+  }
+}
+
+static void
+ZCB_CoalesceHoldTimeout(__attribute__((unused)) SSwTimer *pTimer)
+{
+  CoalesceFlush();
+}
+
+static bool
+CoalesceCmd(uint8_t cmd)
+{
+  return (FUNC_ID_APPLICATION_COMMAND_HANDLER == cmd)
+         || (FUNC_ID_APPLICATION_COMMAND_HANDLER_BRIDGE == cmd)
+         || (FUNC_ID_ZW_APPLICATION_UPDATE == cmd);
+}
+
+bool
+UnsolicitedCoalesceSet(bool enable, uint16_t holdMs)
+{
+  if (holdMs > UNSOLICITED_COALESCE_HOLD_MAX_MS) {
+    return false;
+  }
+  if (!CoalesceFlush()) {
+    return false;
+  }
+  coalesce.enabled = enable;
+  coalesce.holdMs = holdMs;
+  return true;
+}
+
 /*=========================   RequestUnsolicited   ===========================
 **    Queues request (command) to be transmitted to remote side
+**    Node updates are queued ahead of application commands.
+**    When coalescing is enabled, application commands and node updates are
+**    collected into one frame while the link is busy.
 **
 **--------------------------------------------------------------------------*/
 bool /*RET  queue status (false queue full)*/
@@ -222,42 +298,79 @@ RequestUnsolicited(
   uint8_t len          /*IN   Length of data           */
   )
 {
-  taskENTER_CRITICAL();
-  // IF slot available in command transmit queue
-  if (commandQueue.requestCnt < MAX_UNSOLICITED_QUEUE) {
-    // Add to command transmit queue
-    commandQueue.requestCnt++;
-    commandQueue.requestQueue[commandQueue.requestIn].wCmd = cmd;
-    if (len > (uint8_t)BUF_SIZE_TX) {
-      assert((uint8_t)BUF_SIZE_TX >= len);
-      len = (uint8_t)BUF_SIZE_TX;
+  tx_class_t txClass = (FUNC_ID_ZW_APPLICATION_UPDATE == cmd) ? TX_CLASS_NODE_UPDATE : TX_CLASS_APP_COMMAND;
+
+  if (coalesce.enabled) {
+    /* Held records the scheduler has no room for go first, refuse anything behind them */
+    if (coalesce.stuck && !CoalesceFlush()) {
+      return false;
     }
-    commandQueue.requestQueue[commandQueue.requestIn].wLen = len;
-    memcpy(&commandQueue.requestQueue[commandQueue.requestIn].wBuf[0], pData, len);
-    // Move queue input pointer to next slot
-    if (++commandQueue.requestIn >= MAX_UNSOLICITED_QUEUE) {
-      commandQueue.requestIn = 0;
+    if (CoalesceCmd(cmd) && ((COALESCE_RECORD_HEADER + len) <= BUF_SIZE_TX)) {
+      if (((coalesce.length + COALESCE_RECORD_HEADER + len) > BUF_SIZE_TX) && !CoalesceFlush()) {
+        return false;
+      }
+      if (0 == coalesce.records) {
+        coalesce.txClass = TX_CLASS_APP_COMMAND;
+        if (coalesce.holdMs) {
+          TimerStart(&coalesce.holdTimer, coalesce.holdMs);
+        }
+      }
+      /* The frame carries node updates, keep their priority */
+      if (TX_CLASS_NODE_UPDATE == txClass) {
+        coalesce.txClass = txClass;
+      }
+      coalesce.buffer[coalesce.length++] = len;
+      coalesce.buffer[coalesce.length++] = cmd;
+      memcpy(&coalesce.buffer[coalesce.length], pData, len);
+      coalesce.length = (uint8_t)(coalesce.length + len);
+      coalesce.records++;
+      xTaskNotify(g_AppTaskHandle,
+                  1 << EAPPLICATIONEVENT_STATECHANGE,
+                  eSetBits);
+      return true;
+    }
+    /* Unsolicited frames must reach the host in the order they were requested */
+    if (!CoalesceFlush()) {
+      return false;
     }
-    taskEXIT_CRITICAL();
-    xTaskNotify(g_AppTaskHandle,
-                1 << EAPPLICATIONEVENT_STATECHANGE,
-                eSetBits);
-    return true;
   }
-  taskEXIT_CRITICAL();
-  return false;
+  return Enqueue(txClass, cmd, pData, len);
 }
 
-void PurgeCallbackQueue(void)
+/*============================   TransmitWindow   ============================
+**    Transmit queued frames in scheduler order until the negotiated window
+**    is full.
+**
+**--------------------------------------------------------------------------*/
+static bool /*RET  true if at least one frame was transmitted */
+TransmitWindow(void)
 {
-  callbackQueue.requestOut = callbackQueue.requestIn = callbackQueue.requestCnt = 0;
+  bool transmitted = false;
+  while (!comm_interface_tx_window_full()) {
+    uint8_t slot = tx_scheduler_next();
+    if (TX_SCHEDULER_NONE == slot) {
+      break;
+    }
+    /* The slot is the window tag, it is released when the frame is acknowledged */
+    comm_interface_transmit_window_frame(tx_scheduler_frame(slot), slot);
+    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: CMD = 0x%02X, in flight = %d\r\n", __FUNCTION__, tx_scheduler_frame(slot)[FRAME_CMD_IDX], comm_interface_tx_window_outstanding());
+    transmitted = true;
+  }
+  return transmitted;
 }
 
-void PurgeCommandQueue(void)
+/*=========================   PopTransmitWindow   ============================
+**    Release the scheduler slots of frames acknowledged (or given up) in
+**    windowed mode.
+**
+**--------------------------------------------------------------------------*/
+static void
+PopTransmitWindow(void)
 {
-  taskENTER_CRITICAL();
-  commandQueue.requestOut = commandQueue.requestIn = commandQueue.requestCnt = 0;
-  taskEXIT_CRITICAL();
+  uint8_t slot;
+  while (comm_interface_tx_window_pop_acked(&slot)) {
+    tx_scheduler_release(slot);
+  }
 }
 
 /*===============================   Respond   ===============================
@@ -273,6 +386,15 @@ Respond(
   uint8_t len                /*IN   Length of data           */
   )
 {
+  if (NULL != pRespondCapture) {
+    respondCaptured = true;
+    respondCaptureLength = len;
+    if (len <= respondCaptureSize) {
+      memcpy(pRespondCapture, pData, len);
+    }
+    return;
+  }
+  cmd_latency_response_sent(cmd);
   /* If there are no data; pData == NULL and len == 0 we must set the data pointer */
   /* to some dummy data. comm_interface_transmit_frame interprets NULL pointer as retransmit indication */
   if (len == 0) {
@@ -283,6 +405,23 @@ Respond(
   set_state_and_notify(stateTxSerial); /* We want ACK/NAK...*/
 }
 
+void
+RespondCaptureStart(uint8_t *pBuffer, uint8_t size)
+{
+  pRespondCapture = pBuffer;
+  respondCaptureSize = size;
+  respondCaptureLength = 0;
+  respondCaptured = false;
+}
+
+bool
+RespondCaptureStop(uint8_t *pLength)
+{
+  pRespondCapture = NULL;
+  *pLength = respondCaptureLength;
+  return respondCaptured;
+}
+
 void
 DoRespond(uint8_t retVal)
 {
@@ -342,12 +481,16 @@ void zaf_event_distributor_app_zw_command_status(SZwaveCommandStatusPackage *Sta
   switch (Status->eStatusType) {
     case EZWAVECOMMANDSTATUS_LEARN_MODE_STATUS:
       ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: EZWAVECOMMANDSTATUS_LEARN_MODE_STATUS\r\n", __FUNCTION__);
+      // Learn mode may have included, excluded or replicated us, also when the host gave no funcID
+      NodeListCacheInvalidate();
       SyncEventArg1Invoke(&LearnModeStatusCb, Status->Content.LearnModeStatus.Status);
       break;
 
     case EZWAVECOMMANDSTATUS_SET_DEFAULT:
       ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: EZWAVECOMMANDSTATUS_SET_DEFAULT\r\n", __FUNCTION__);
       // Received when protocol is started (not implemented yet), and when SetDefault command is completed
+      NodeListCacheInvalidate();
+      SendDataTransactionsReset();
       SyncEventInvoke(&SetDefaultCB);
       break;
 
@@ -427,6 +570,7 @@ appFileSystemInit(void)
     ReadApplicationMaxLRTxPwr(&RadioConfig->iTxPowerLevelMaxLR);
     ReadApplicationEnablePTI(&RadioConfig->radio_debug_enable);
     ReadApplicationNodeIdBaseType(&nodeIdBaseType);
+    ReadApplicationUartBaudRate(&uartBaudRate);
   } else {
     /*
      * We end up here on the first boot after initializing the flash file system
@@ -519,7 +663,9 @@ static void SerialAPIStateHandler(void)
   /* ApplicationPoll is controlled by a statemachine with the four states:
       stateIdle, stateFrameParse, stateTxSerial, stateCbTxSerial.
 
-      stateIdle: If there is anything to transmit do so. -> stateCbTxSerial
+      stateIdle: Queue coalesced unsolicited frames once nothing else is waiting.
+                 Handle host frames kept while waiting for an ACK. -> stateFrameParse
+                 If there is anything to transmit do so, in tx_scheduler order. -> stateCbTxSerial
                  If not, check if anything is received. -> stateFrameParse
                  If neither, stay in the state
                  Note: frames received while we are transmitting are lost
@@ -535,9 +681,14 @@ static void SerialAPIStateHandler(void)
 
       stateCbTxSerial:  Waits for ack on requests send in stateIdle
                   (callback, ApplicationCommandHandler etc).
-                 Retransmit frame as needed and remove from callbackqueue when done.
+                 Retransmit frame as needed and release its tx_scheduler slot when done.
                  -> stateIdle
 
+      stateWindowTxSerial: Only used when a transmit window has been negotiated.
+                 Keeps up to window size requests in flight, releases their
+                 slots on cumulative ACK and goes back N on NAK/timeout.
+                 -> stateIdle when nothing is in flight
+
      stateAppSuspend: Added for the uzb suspend function. The resume is through the suspend signal goes high in UZB stick
                      The wakeup from deep sleep suspend causes system reboot
 
@@ -547,7 +698,7 @@ static void SerialAPIStateHandler(void)
     switch (state) {
       case stateStartup:
       {
-        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: stateStartup\r\n", __FUNCTION__);
+        BINLOG_DEBUG("%s: stateStartup\r\n", __FUNCTION__);
         ApplicationInitSW();
         SetRFReceiveMode(1);
         set_state_and_notify(stateIdle);
@@ -556,39 +707,27 @@ static void SerialAPIStateHandler(void)
 
       case stateIdle:
       {
-        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: stateIdle\r\n", __FUNCTION__);
-        /* Check if there is anything to transmit. If so do it */
-        if (callbackQueue.requestCnt) {
-          ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: callbackQueue.requestCnt = %d\r\n", __FUNCTION__, callbackQueue.requestCnt);
-          ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: CMD = 0x%02X\r\n", __FUNCTION__, callbackQueue.requestQueue[callbackQueue.requestOut].wCmd);
-          comm_interface_transmit_frame(
-            callbackQueue.requestQueue[callbackQueue.requestOut].wCmd,
-            REQUEST,
-            (uint8_t *)callbackQueue.requestQueue[callbackQueue.requestOut].wBuf,
-            callbackQueue.requestQueue[callbackQueue.requestOut].wLen,
-            NULL
-            );
+        BINLOG_DEBUG("%s: stateIdle\r\n", __FUNCTION__);
+        CoalescePoll();
+        /* Host frames acknowledged while we waited for an ACK are handled first.
+           Then check if there is anything to transmit. If so do it */
+        if (comm_interface_rx_pending() && (comm_interface_parse_data(true) == PARSE_FRAME_RECEIVED)) {
+          cmd_latency_request_received(serial_frame->cmd, comm_interface_frame_timestamp());
+          set_state_and_notify(stateFrameParse);
+        } else if (comm_interface_get_tx_window() && TransmitWindow()) {
+          set_state_and_notify(stateWindowTxSerial);
+          /* Slots are released when acknowledged from PC - or timed out after retries */
+        } else if (TX_SCHEDULER_NONE != (txSlot = tx_scheduler_next())) {
+          BINLOG_DEBUG("%s: CMD = 0x%02X\r\n", __FUNCTION__, tx_scheduler_frame(txSlot)[FRAME_CMD_IDX]);
+          comm_interface_transmit_framed(tx_scheduler_frame(txSlot), NULL);
           set_state_and_notify(stateCallbackTxSerial);
-          /* callbackCnt decremented when frame is acknowledged from PC - or timed out after retries */
+          /* Slot released when frame is acknowledged from PC - or timed out after retries */
         } else {
-          /* Check if there is anything to transmit. If so do it */
-          if (commandQueue.requestCnt) {
-            ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: commandQueue.requestCnt = %d\r\n", __FUNCTION__, commandQueue.requestCnt);
-            comm_interface_transmit_frame(
-              commandQueue.requestQueue[commandQueue.requestOut].wCmd,
-              REQUEST,
-              (uint8_t *)commandQueue.requestQueue[commandQueue.requestOut].wBuf,
-              commandQueue.requestQueue[commandQueue.requestOut].wLen,
-              NULL
-              );
-            set_state_and_notify(stateCommandTxSerial);
-            /* commandCnt decremented when frame is acknowledged from PC - or timed out after retries */
-          } else {
-            /* Nothing to transmit. Check if we received anything */
-            if (comm_interface_parse_data(true) == PARSE_FRAME_RECEIVED) {
-              /* We got a frame... */
-              set_state_and_notify(stateFrameParse);
-            }
+          /* Nothing to transmit. Check if we received anything */
+          if (comm_interface_parse_data(true) == PARSE_FRAME_RECEIVED) {
+            /* We got a frame... */
+            cmd_latency_request_received(serial_frame->cmd, comm_interface_frame_timestamp());
+            set_state_and_notify(stateFrameParse);
           }
         }
       }
@@ -596,28 +735,31 @@ static void SerialAPIStateHandler(void)
 
       case stateFrameParse:
       {
-        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: stateFrameParse\r\n", __FUNCTION__);
+        BINLOG_DEBUG("%s: stateFrameParse\r\n", __FUNCTION__);
         SerialAPICommandHandler();
       }
       break;
 
       case stateTxSerial:
       {
-        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: stateTxSerial\r\n", __FUNCTION__);
+        BINLOG_DEBUG("%s: stateTxSerial\r\n", __FUNCTION__);
         /* Wait for ACK on send respond. Retransmit as needed */
         if ((conVal = comm_interface_parse_data(false)) == PARSE_FRAME_SENT) {
-          ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: RES transmitted successfully\r\n", __FUNCTION__);
+          BINLOG_DEBUG("%s: RES transmitted successfully\r\n", __FUNCTION__);
           /* One more RES transmitted successfully */
+          cmd_latency_response_acked();
           retry = 0;
           set_state_and_notify(stateIdle);
-        } else if (conVal == PARSE_TX_TIMEOUT) {
+        } else if ((conVal == PARSE_TX_TIMEOUT) || (conVal == PARSE_TX_NAK)) {
           /* Either a NAK has been received or we timed out waiting for ACK */
           if (retry++ < MAX_SERIAL_RETRY) {
-            ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: retransmitting...\r\n", __FUNCTION__);
+            BINLOG_DEBUG("%s: retransmitting...\r\n", __FUNCTION__);
             comm_interface_transmit_frame(0, REQUEST, NULL, 0, NULL); /* Retry... */
           } else {
-              ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: Drop RES as HOST could not be reached\r\n", __FUNCTION__);
+              BINLOG_DEBUG("%s: Drop RES as HOST could not be reached\r\n", __FUNCTION__);
             /* Drop RES as HOST could not be reached */
+            appLinkStats.resDropped++;
+            cmd_latency_response_dropped();
             retry = 0;
             set_state_and_notify(stateIdle);
           }
@@ -628,53 +770,61 @@ static void SerialAPIStateHandler(void)
 
       case stateCallbackTxSerial:
       {
-        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: stateCallbackTxSerial\r\n", __FUNCTION__);
-        /* Wait for ack on unsolicited event (callback etc.) */
-        /* Retransmit as needed. Remove frame from callbackQueue when done */
+        BINLOG_DEBUG("%s: stateCallbackTxSerial\r\n", __FUNCTION__);
+        /* Wait for ack on request (callback, ApplicationCommandHandler etc.) */
+        /* Retransmit as needed. Release scheduler slot when done */
         if ((conVal = comm_interface_parse_data(false)) == PARSE_FRAME_SENT) {
-          ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: REQ transmitted successfully\r\n", __FUNCTION__);
+          BINLOG_DEBUG("%s: REQ transmitted successfully\r\n", __FUNCTION__);
           /* One more REQ transmitted successfully */
-          PopCallBackQueue();
-        } else if (conVal == PARSE_TX_TIMEOUT) {
+          PopRequest();
+        } else if ((conVal == PARSE_TX_TIMEOUT) || (conVal == PARSE_TX_NAK)) {
           /* Either a NAK has been received or we timed out waiting for ACK */
           if (retry++ < MAX_SERIAL_RETRY) {
-            ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: retransmitting...\r\n", __FUNCTION__);
+            BINLOG_DEBUG("%s: retransmitting...\r\n", __FUNCTION__);
             comm_interface_transmit_frame(0, REQUEST, NULL, 0, NULL); /* Retry... */
           } else {
-            ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: Drop REQ as HOST could not be reached\r\n", __FUNCTION__);
+            BINLOG_DEBUG("%s: Drop REQ as HOST could not be reached\r\n", __FUNCTION__);
             /* Drop REQ as HOST could not be reached */
-            PopCallBackQueue();
+            appLinkStats.reqDropped++;
+            PopRequest();
           }
         }
         /* All other states are ignored, as for now the only thing we are looking for is ACK/NAK! */
       }
       break;
 
-      case stateCommandTxSerial:
+      case stateWindowTxSerial:
       {
-        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: stateCommandTxSerial\r\n", __FUNCTION__);
-        /* Wait for ack on unsolicited ApplicationCommandHandler event */
-        /* Retransmit as needed. Remove frame from comamndQueue when done */
+        BINLOG_DEBUG("%s: stateWindowTxSerial\r\n", __FUNCTION__);
+        /* Wait for cumulative ACKs on the frames in flight and keep the window filled */
         if ((conVal = comm_interface_parse_data(false)) == PARSE_FRAME_SENT) {
-          ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: REQ transmitted successfully\r\n", __FUNCTION__);
-          /* One more REQ transmitted successfully */
-          PopCommandQueue();
-        } else if (conVal == PARSE_TX_TIMEOUT) {
+          BINLOG_DEBUG("%s: REQ window acknowledged\r\n", __FUNCTION__);
+          retry = 0;
+        } else if ((conVal == PARSE_TX_TIMEOUT) || (conVal == PARSE_TX_NAK)) {
           /* Either a NAK has been received or we timed out waiting for ACK */
           if (retry++ < MAX_SERIAL_RETRY) {
-            ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: retransmitting...\r\n", __FUNCTION__);
-            comm_interface_transmit_frame(0, REQUEST, NULL, 0, NULL); /* Retry... */
+            BINLOG_DEBUG("%s: retransmitting window...\r\n", __FUNCTION__);
+            comm_interface_transmit_frame(0, REQUEST, NULL, 0, NULL); /* Go back N... */
           } else {
-            ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: Drop REQ as HOST could not be reached\r\n", __FUNCTION__);
-            /* Drop REQ as HOST could not be reached */
-            PopCommandQueue();
+            BINLOG_DEBUG("%s: Drop REQ window as HOST could not be reached\r\n", __FUNCTION__);
+            appLinkStats.reqDropped += comm_interface_tx_window_outstanding();
+            comm_interface_tx_window_abort();
+            retry = 0;
           }
         }
-        /* All other states are ignored, as for now the only thing we are looking for is ACK/NAK! */
+        PopTransmitWindow();
+        CoalescePoll();
+        /* Let the window drain so host frames kept meanwhile get handled */
+        if (!comm_interface_rx_pending()) {
+          TransmitWindow();
+        }
+        if (0 == comm_interface_tx_window_outstanding()) {
+          set_state_and_notify(stateIdle);
+        }
       }
       break;
       default:
-        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: default\r\n", __FUNCTION__);
+        BINLOG_DEBUG("%s: default\r\n", __FUNCTION__);
         set_state_and_notify(stateIdle);
         break;
     }
@@ -700,31 +850,10 @@ zaf_event_distributor_app_serial_timeout(void)
 }
 
 void
-PopCallBackQueue(void)
+PopRequest(void)
 {
-  if (callbackQueue.requestCnt) {
-    callbackQueue.requestCnt--;
-    if (++callbackQueue.requestOut >= MAX_CALLBACK_QUEUE) {
-      callbackQueue.requestOut = 0;
-    }
-  } else {
-    callbackQueue.requestOut = callbackQueue.requestIn;
-  }
-  retry = 0;
-  set_state_and_notify(stateIdle);
-}
-
-void
-PopCommandQueue(void)
-{
-  if (commandQueue.requestCnt) {
-    commandQueue.requestCnt--;
-    if (++commandQueue.requestOut >= MAX_UNSOLICITED_QUEUE) {
-      commandQueue.requestOut = 0;
-    }
-  } else {
-    commandQueue.requestOut = commandQueue.requestIn;
-  }
+  tx_scheduler_release(txSlot);
+  txSlot = TX_SCHEDULER_NONE;
   retry = 0;
   set_state_and_notify(stateIdle);
 }
@@ -753,7 +882,11 @@ ApplicationInitSW(void)
   AppNodeInfo = zaf_get_app_node_info();
   RadioConfig = zaf_get_radio_config();
 
-  comm_interface_init();
+  binlog_init();
+  cmd_handlers_init();
+  tx_scheduler_init();
+  AppTimerRegister(&coalesce.holdTimer, false, ZCB_CoalesceHoldTimeout);
+  comm_interface_init(uartBaudRate);
 
   // FIXME load any saved node configuration and prepare to feed it to protocol
 /* Do we together with the bTxStatus uint8_t also transmit a sTxStatusReport struct on ZW_SendData callback to HOST */
@@ -1107,6 +1240,13 @@ ApplicationNodeUpdate(
   )
 {
   uint8_t offset = 0;
+#ifdef ZW_CONTROLLER
+  /* Another controller changed the network */
+  if ((UPDATE_STATE_NEW_ID_ASSIGNED == bStatus) || (UPDATE_STATE_DELETE_DONE == bStatus)
+      || (UPDATE_STATE_SUC_ID == bStatus)) {
+    NodeListCacheInvalidate();
+  }
+#endif
   compl_workbuf[0] = bStatus;
   if (SERIAL_API_SETUP_NODEID_BASE_TYPE_16_BIT == nodeIdBaseType) {
     compl_workbuf[1] = (uint8_t)(nodeID >> 8);     // MSB
@@ -1131,5 +1271,35 @@ ApplicationNodeUpdate(
 
 ZW_WEAK const void * SerialAPI_get_uart_config_ext(void)
 {
+#if defined(SERIAL_API_CTS_PORT)
+  /* The USART holds back transmission while the host deasserts CTS. RTS is left out, see SerialAPI_set_rts(). */
+  static const zpal_uart_config_ext_t uart_config_ext = {
+    .txd_pin  = SERIAL_API_TX_PIN,
+    .txd_port = SERIAL_API_TX_PORT,
+    .rxd_pin  = SERIAL_API_RX_PIN,
+    .rxd_port = SERIAL_API_RX_PORT,
+    .cts_pin  = SERIAL_API_CTS_PIN,
+    .cts_port = SERIAL_API_CTS_PORT,
+  };
+  return &uart_config_ext;
+#else
   return NULL;
+#endif
+}
+
+ZW_WEAK void SerialAPI_set_rts(__attribute__((unused)) bool ready)
+{
+#if defined(SERIAL_API_RTS_PORT)
+  static bool configured = false;
+
+  /* RTS is active low. The first call comes from the application task when the UART is opened. */
+  if (!configured) {
+    GPIO_PinModeSet((GPIO_Port_TypeDef)SERIAL_API_RTS_PORT, SERIAL_API_RTS_PIN, gpioModePushPull, ready ? 0 : 1);
+    configured = true;
+  } else if (ready) {
+    GPIO_PinOutClear((GPIO_Port_TypeDef)SERIAL_API_RTS_PORT, SERIAL_API_RTS_PIN);
+  } else {
+    GPIO_PinOutSet((GPIO_Port_TypeDef)SERIAL_API_RTS_PORT, SERIAL_API_RTS_PIN);
+  }
+#endif
 }
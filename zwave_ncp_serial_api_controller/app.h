@@ -64,8 +64,8 @@ enum {
   stateTxSerial,
   stateFrameParse,
   stateCallbackTxSerial,
-  stateCommandTxSerial,
-  stateAppSuspend
+  stateAppSuspend,
+  stateWindowTxSerial
 };
 
 /* States for FUNC_ID_NVM_BACKUP_RESTORE operation */
@@ -73,7 +73,11 @@ typedef enum {
   NVMBackupRestoreOperationOpen,
   NVMBackupRestoreOperationRead,
   NVMBackupRestoreOperationWrite,
-  NVMBackupRestoreOperationClose
+  NVMBackupRestoreOperationClose,
+  NVMBackupRestoreOperationStream,            /* FUNC_ID_NVM_EXT_BACKUP_RESTORE only */
+  NVMBackupRestoreOperationStreamCompressed,  /* FUNC_ID_NVM_EXT_BACKUP_RESTORE only */
+  NVMBackupRestoreOperationWriteCompressed,   /* FUNC_ID_NVM_EXT_BACKUP_RESTORE only */
+  NVMBackupRestoreOperationDigest             /* FUNC_ID_NVM_EXT_BACKUP_RESTORE only */
 } eNVMBackupRestoreOperation;
 
 /* Return values for FUNC_ID_NVM_BACKUP_RESTORE operation */
@@ -221,6 +225,20 @@ extern bool RequestUnsolicited(
   uint8_t len              /*IN   Length of data           */
   );
 
+/**
+ * Coalesce unsolicited frames (application commands and node updates).
+ *
+ * While other frames keep the link busy these frames are collected into one
+ * FUNC_ID_SERIAL_API_COALESCED frame holding { length | cmd | payload[length] } records, in the
+ * order they were requested. A single record is sent as a plain frame.
+ *
+ * @param enable true to coalesce, false to send every frame on its own
+ * @param holdMs Longest time a frame is held for others to join it. 0 only holds frames while
+ *               another frame is in flight.
+ * @return false if @p holdMs is out of range, or if frames held so far could not be queued.
+ */
+extern bool UnsolicitedCoalesceSet(bool enable, uint16_t holdMs);
+
 extern void Respond(
   uint8_t cmd,             /*IN   Command                  */
   uint8_t const * pData,         /*IN   pointer to data          */
@@ -228,9 +246,33 @@ extern void Respond(
   );
 extern void DoRespond(uint8_t retVal);
 
-extern void PopCallBackQueue(void);
+/**
+ * Make Respond() copy the response into a buffer instead of transmitting it, until
+ * RespondCaptureStop() is called. Used to run batched sub-commands.
+ *
+ * @param pBuffer Buffer for the response payload
+ * @param size Size of @p pBuffer
+ */
+extern void RespondCaptureStart(uint8_t *pBuffer, uint8_t size);
+
+/**
+ * Transmit responses again.
+ *
+ * @param pLength Length of the captured response. The response is only copied if it fits in the
+ *                buffer given to RespondCaptureStart().
+ * @return true if Respond() was called since RespondCaptureStart().
+ */
+extern bool RespondCaptureStop(uint8_t *pLength);
+
+extern void PopRequest(void);
+
+/* Frames given up after MAX_SERIAL_RETRY, counted since start up or the last reset */
+typedef struct {
+  uint32_t resDropped;  ///< RESPONSE frames
+  uint32_t reqDropped;  ///< REQUEST frames
+} app_link_stats_t;
 
-extern void PopCommandQueue(void);
+extern app_link_stats_t appLinkStats;
 
 extern uint8_t GetCallbackCnt(void);
 
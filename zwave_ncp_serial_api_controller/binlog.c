@@ -0,0 +1,159 @@
+/**
+ * @file
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "binlog.h"
+#include "zw_log_config.h"
+#include "sl_iostream.h"
+#include "sl_iostream_handles.h"
+
+_Static_assert((BINLOG_RECORDS & (BINLOG_RECORDS - 1)) == 0, "STATIC_ASSERT_BINLOG_RECORDS_not_power_of_2");
+
+#define BINLOG_HEADER_SIZE  11  // sync[2] | nargs | format[4] | timestamp[4]
+#define BINLOG_TASK_STACK   (configMINIMAL_STACK_SIZE + 64)
+
+typedef struct {
+  atomic_uint_fast32_t seq;   // index + 1 once the record is complete, 0 while it is written
+  uint32_t fmt;
+  uint32_t timestamp;
+  uint32_t args[BINLOG_MAX_ARGS];
+  uint8_t nargs;
+} binlog_record_t;
+
+static binlog_record_t ring[BINLOG_RECORDS];
+static atomic_uint_fast32_t head;   // index of the next record to reserve
+static uint32_t tail;               // index of the next record to drain, only used by the task
+static uint32_t lost;
+
+static StaticTask_t task_buffer;
+static StackType_t task_stack[BINLOG_TASK_STACK];
+static TaskHandle_t task_handle;    // NULL until binlog_init() has found the log channel
+static sl_iostream_t *stream;
+
+void binlog_write(const char *fmt, uint8_t nargs, ...)
+{
+  const uint32_t index = (uint32_t)atomic_fetch_add_explicit(&head, 1, memory_order_relaxed);
+  binlog_record_t *record = &ring[index & (BINLOG_RECORDS - 1)];
+
+  atomic_store_explicit(&record->seq, 0, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  record->fmt = (uint32_t)(uintptr_t)fmt;
+  record->timestamp = xPortIsInsideInterrupt() ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+  record->nargs = (nargs < BINLOG_MAX_ARGS) ? nargs : BINLOG_MAX_ARGS;
+  va_list ap;
+  va_start(ap, nargs);
+  for (uint8_t i = 0; i < record->nargs; i++) {
+    record->args[i] = va_arg(ap, uint32_t);
+  }
+  va_end(ap);
+  atomic_store_explicit(&record->seq, index + 1, memory_order_release);
+
+  if (NULL == task_handle) {
+    return;
+  }
+  if (xPortIsInsideInterrupt()) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(task_handle, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  } else {
+    xTaskNotifyGive(task_handle);
+  }
+}
+
+static uint8_t put_32bit_value_le(uint8_t *pBuffer, uint32_t value)
+{
+  pBuffer[0] = (uint8_t)value;
+  pBuffer[1] = (uint8_t)(value >> 8);
+  pBuffer[2] = (uint8_t)(value >> 16);
+  pBuffer[3] = (uint8_t)(value >> 24);
+  return 4;
+}
+
+static void emit(uint32_t fmt, uint32_t timestamp, const uint32_t *pArgs, uint8_t nargs)
+{
+  uint8_t buffer[BINLOG_HEADER_SIZE + (4 * BINLOG_MAX_ARGS)];
+  uint8_t i = 0;
+  buffer[i++] = BINLOG_SYNC_0;
+  buffer[i++] = BINLOG_SYNC_1;
+  buffer[i++] = nargs;
+  i += put_32bit_value_le(&buffer[i], fmt);
+  i += put_32bit_value_le(&buffer[i], timestamp);
+  for (uint8_t n = 0; n < nargs; n++) {
+    i += put_32bit_value_le(&buffer[i], pArgs[n]);
+  }
+  sl_iostream_write(stream, buffer, i);
+}
+
+/* Take the next complete record out of the ring. Returns false if there is none. */
+static bool drain_one(binlog_record_t *pRecord)
+{
+  const binlog_record_t *record = &ring[tail & (BINLOG_RECORDS - 1)];
+  const uint32_t seq = (uint32_t)atomic_load_explicit(&record->seq, memory_order_acquire);
+
+  if (seq == (tail + 1)) {
+    pRecord->fmt = record->fmt;
+    pRecord->timestamp = record->timestamp;
+    pRecord->nargs = record->nargs;
+    memcpy(pRecord->args, record->args, sizeof(pRecord->args));
+    atomic_thread_fence(memory_order_acquire);
+    /* The record may have been overwritten while it was copied */
+    if ((uint32_t)atomic_load_explicit(&record->seq, memory_order_relaxed) == seq) {
+      tail++;
+      return true;
+    }
+  } else if ((0 == seq) || ((int32_t)(seq - (tail + 1)) < 0)) {
+    return false;   // Not complete yet
+  }
+
+  /* Overwritten: skip to the oldest record still in the ring */
+  const uint32_t oldest = (uint32_t)atomic_load_explicit(&head, memory_order_relaxed) - BINLOG_RECORDS;
+  if ((int32_t)(oldest - tail) > 0) {
+    lost += oldest - tail;
+    tail = oldest;
+  } else {
+    lost++;
+    tail++;
+  }
+  pRecord->fmt = 0;
+  pRecord->timestamp = xTaskGetTickCount();
+  pRecord->nargs = 1;
+  pRecord->args[0] = lost;
+  return true;
+}
+
+/* Sleeps until binlog_write() notifies it, so an idle ring costs no wake-ups */
+static void binlog_task(__attribute__((unused)) void *pParameters)
+{
+  binlog_record_t record;
+
+  for (;;) {
+    while (drain_one(&record)) {
+      emit(record.fmt, record.timestamp, record.args, record.nargs);
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+void binlog_init(void)
+{
+  if (NULL != task_handle) {
+    return;
+  }
+  stream = sl_iostream_get_handle(BINLOG_CHANNEL);
+  if (NULL == stream) {
+    /* Nowhere to write to, records just cycle through the ring */
+    return;
+  }
+  task_handle = xTaskCreateStatic(binlog_task, "BinLog", BINLOG_TASK_STACK, NULL,
+                                  tskIDLE_PRIORITY + 1, task_stack, &task_buffer);
+}
+
+uint32_t binlog_lost(void)
+{
+  return lost;
+}
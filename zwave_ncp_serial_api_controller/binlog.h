@@ -0,0 +1,95 @@
+/**
+ * @file
+ * Deferred binary logging.
+ *
+ * BINLOG_DEBUG() stores the address of the format string, a tick count timestamp and the raw
+ * arguments in a RAM ring instead of formatting the message. Writers reserve a record with one
+ * atomic increment, so the ring can be written from any task or interrupt without a lock. A low
+ * priority task, notified by each write, drains the ring to the log channel.
+ *
+ * tools/binlog_decode.py turns the records back into text using the ELF file of the build. The
+ * format string and any %s argument must therefore point to constant strings, like __FUNCTION__.
+ * Arguments are stored as 32 bit values, so floating point arguments are not supported.
+ *
+ * Each record is written to the log channel as
+ *   BINLOG_SYNC_0 | BINLOG_SYNC_1 | nargs | format[4] | timestamp[4] | args[4 * nargs]
+ * with all values little endian. Records lost because the ring was full are reported by a record
+ * with format address 0 and the total number of lost records as the only argument.
+ *
+ * By default the records share the debug channel with the ZPAL_LOG_*() text. Each record is written
+ * in one piece, and the decoder passes everything between records through as text and resyncs on
+ * the sync bytes. Set BINLOG_CHANNEL to an IO Stream instance of its own to keep them apart.
+ *
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#ifndef _BINLOG_H_
+#define _BINLOG_H_
+
+#include <stdint.h>
+#include "zpal_log.h"
+
+/* Set to 0 to format BINLOG_DEBUG() messages at the call site with ZPAL_LOG_DEBUG() again */
+#if !defined(BINLOG_ENABLED)
+#define BINLOG_ENABLED            1
+#endif
+
+/* Number of records in the ring, must be a power of 2 */
+#if !defined(BINLOG_RECORDS)
+#define BINLOG_RECORDS            32
+#endif
+
+/* IO Stream instance the records are written to, shared with the text logs by default */
+#if !defined(BINLOG_CHANNEL)
+#define BINLOG_CHANNEL            ZW_LOG_CHANNEL_DEBUG
+#endif
+
+#define BINLOG_MAX_ARGS           5
+#define BINLOG_SYNC_0             0xA5
+#define BINLOG_SYNC_1             0x5A
+
+#if BINLOG_ENABLED
+
+/* Number of arguments after the format string, 0 to BINLOG_MAX_ARGS */
+#define BINLOG_NARGS(...)   BINLOG_NARGS_(_, ##__VA_ARGS__, 5, 4, 3, 2, 1, 0)
+#define BINLOG_NARGS_(_0, _1, _2, _3, _4, _5, N, ...) N
+
+/* Every argument is passed on as uint32_t */
+#define BINLOG_ARG(a)       (uint32_t)(uintptr_t)(a)
+#define BINLOG_ARGS_0()
+#define BINLOG_ARGS_1(a)                    , BINLOG_ARG(a)
+#define BINLOG_ARGS_2(a, b)                 , BINLOG_ARG(a), BINLOG_ARG(b)
+#define BINLOG_ARGS_3(a, b, c)              , BINLOG_ARG(a), BINLOG_ARG(b), BINLOG_ARG(c)
+#define BINLOG_ARGS_4(a, b, c, d)           , BINLOG_ARG(a), BINLOG_ARG(b), BINLOG_ARG(c), BINLOG_ARG(d)
+#define BINLOG_ARGS_5(a, b, c, d, e)        , BINLOG_ARG(a), BINLOG_ARG(b), BINLOG_ARG(c), BINLOG_ARG(d), BINLOG_ARG(e)
+#define BINLOG_ARGS(n, ...)                 BINLOG_ARGS__(n, __VA_ARGS__)
+#define BINLOG_ARGS__(n, ...)               BINLOG_ARGS_##n(__VA_ARGS__)
+
+#define BINLOG_DEBUG(fmt, ...) \
+  binlog_write(fmt, BINLOG_NARGS(__VA_ARGS__) BINLOG_ARGS(BINLOG_NARGS(__VA_ARGS__), ##__VA_ARGS__))
+
+#else
+
+#define BINLOG_DEBUG(fmt, ...)  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, fmt, ##__VA_ARGS__)
+
+#endif /* BINLOG_ENABLED */
+
+/**
+ * Start the task draining the ring. Records written before are kept. The task is not started if
+ * BINLOG_CHANNEL has no IO Stream instance.
+ */
+void binlog_init(void);
+
+/**
+ * Store a record in the ring. Use BINLOG_DEBUG() instead of calling this directly.
+ *
+ * @param fmt Format string, must be a constant string
+ * @param nargs Number of uint32_t arguments following
+ */
+void binlog_write(const char *fmt, uint8_t nargs, ...);
+
+/**
+ * @return Number of records overwritten before they were written to the log channel.
+ */
+uint32_t binlog_lost(void);
+
+#endif /* _BINLOG_H_ */
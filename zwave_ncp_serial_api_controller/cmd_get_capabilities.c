@@ -3,6 +3,7 @@
  * @copyright 2022 Silicon Laboratories Inc.
  */
 #include <stdint.h>
+#include <string.h>
 
 #include <NodeMask.h>
 
@@ -13,7 +14,7 @@
 #include "nvm_backup_restore.h"
 #include "zpal_log.h"
 
-#define CAPABILITIES_SIZE (8 + 32) // Info + supported commands
+#define CAPABILITIES_SIZE (8 + CMD_SUPPORTED_MASK_SIZE) // Info + supported commands
 
 /* Serial API application manufacturer_id */
 #define SERIALAPI_MANUFACTURER_ID1           (uint8_t)((ZAF_CONFIG_MANUFACTURER_ID & 0xFF00) >> 8) /* MSB */
@@ -36,15 +37,9 @@ static uint8_t SERIALAPI_CAPABILITIES[CAPABILITIES_SIZE] = {
   SERIALAPI_MANUFACTURER_PRODUCT_ID2
 };
 
-static bool add_cmd_to_capabilities(cmd_handler_map_t const * const p_cmd_entry, uint8_t* supported_cmds_mask)
-{
-  *(supported_cmds_mask + ((p_cmd_entry->cmd - 1) >> 3)) |= (0x1 << ((p_cmd_entry->cmd - 1) & 7));
-  return false;
-}
-
 ZW_ADD_CMD(FUNC_ID_SERIAL_API_GET_CAPABILITIES)
 {
-  cmd_foreach(add_cmd_to_capabilities, &SERIALAPI_CAPABILITIES[8]);
+  memcpy(&SERIALAPI_CAPABILITIES[8], cmd_supported_mask(), CMD_SUPPORTED_MASK_SIZE);
 
 #if SUPPORT_NVM_BACKUP_RESTORE
   //If the legacy NVM backup & restore command cannot be used, it must be removed from available command.
@@ -14,6 +14,8 @@
 #include <SizeOf.h>
 #include <zpal_misc.h>
 #include <zpal_watchdog.h>
+#include <FreeRTOS.h>
+#include <task.h>
 #include "zpal_log.h"
 
 #include "app_node_info.h"
@@ -27,6 +29,8 @@
 #include "serialapi_file.h"
 #include "utils.h"
 #include "nvm_backup_restore.h"
+#include "tx_scheduler.h"
+#include "cmd_latency.h"
 #include "zaf_protocol_config.h"
 
 #if SUPPORT_ZW_AES_ECB
@@ -78,6 +82,7 @@ static void Initiate_shutdown_cb(void)
 ZW_ADD_CMD(FUNC_ID_ZW_INITIATE_SHUTDOWN)
 {
   AppTimerStopAll();
+  SerialApiNvmFlushAppData();
   if (InitiateShutdown(&Initiate_shutdown_cb)) {
     set_state_and_notify(stateIdle);
   } else {
@@ -303,10 +308,6 @@ ZW_ADD_CMD(FUNC_ID_ZW_SECURITY_SETUP)
 }
 #endif
 
-#if SUPPORT_ZW_SEND_DATA || SUPPORT_ZW_SEND_DATA_BRIDGE
-uint8_t funcID_ComplHandler_ZW_SendData;
-#endif
-
 #if SUPPORT_ZW_SEND_PROTOCOL_DATA
 
 static struct {
@@ -315,7 +316,14 @@ static struct {
 } nlsEncryptionMetadata = { 0 };
 #endif
 
-#if SUPPORT_ZW_SEND_DATA || SUPPORT_ZW_SEND_DATA_EX || SUPPORT_ZW_SEND_DATA_BRIDGE
+#if SUPPORT_ZW_SEND_DATA || SUPPORT_ZW_SEND_DATA_EX || SUPPORT_ZW_SEND_DATA_MULTI || SUPPORT_ZW_SEND_DATA_MULTI_EX \
+  || SUPPORT_ZW_SEND_DATA_BRIDGE || SUPPORT_ZW_SEND_DATA_MULTI_BRIDGE
+#define SEND_DATA_TRANSACTIONS_USED 1
+#else
+#define SEND_DATA_TRANSACTIONS_USED 0
+#endif
+
+#if SEND_DATA_TRANSACTIONS_USED
 static void
 GenerateTxStatusRequest(
   uint8_t cmd,
@@ -355,21 +363,158 @@ GenerateTxStatusRequest(
   }
   Request(cmd, compl_workbuf, bIdx);
 }
+
+/*
+ * Sends waiting in ZwTxQueue for their completion callback.
+ *
+ * The host may queue a new send before the previous one has completed, so the funcID of each send
+ * is kept in its own entry until the callback. The protocol calls FrameConfig.Handle with the
+ * transmit status only, so every entry has its own completion handler and the handler passed as
+ * FrameConfig.Handle identifies the entry.
+ */
+#if !defined(SEND_DATA_TRANSACTIONS)
+#define SEND_DATA_TRANSACTIONS  8
 #endif
 
-#if SUPPORT_ZW_SEND_DATA
-/*======================   ComplHandler_ZW_SendData   ========================
-**    Completion handler for ZW_SendData
-**
-**--------------------------------------------------------------------------*/
-static void /* RET  Nothing                     */
-ZCB_ComplHandler_ZW_SendData(
+/* Longest time the protocol takes to complete a send, including routing attempts and explorer
+   frames. An entry older than this has lost its callback and is taken for a new send. */
+#if !defined(SEND_DATA_TRANSACTION_TIMEOUT_MS)
+#define SEND_DATA_TRANSACTION_TIMEOUT_MS  65000
+#endif
+
+typedef struct {
+  uint8_t cmd;        // Function ID of the send, 0 if the entry is free
+  uint8_t funcID;     // Returned to the host in the callback
+  TickType_t opened;  // Tick count when the send was received from the host
+} send_data_transaction_t;
+
+static send_data_transaction_t sendDataTransactions[SEND_DATA_TRANSACTIONS];
+
+static void
+SendDataTransactionComplete(
+  uint8_t index,
   uint8_t txStatus,
-  TX_STATUS_TYPE *txStatusReport)   /* IN   Transmit completion status  */
+  TX_STATUS_TYPE *txStatusReport)
+{
+  const send_data_transaction_t transaction = sendDataTransactions[index];
+  sendDataTransactions[index].cmd = 0;
+  if (0 == transaction.cmd) {
+    ZPAL_LOG_WARNING(ZPAL_LOG_APP, "%s: callback %d without a send\r\n", __FUNCTION__, index);
+    return;
+  }
+  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: CMD = 0x%02X, funcID = 0x%02X, %u ticks\r\n", __FUNCTION__,
+                 transaction.cmd, transaction.funcID, (unsigned)(xTaskGetTickCount() - transaction.opened));
+
+  switch (transaction.cmd) {
+    case FUNC_ID_ZW_SEND_DATA_MULTI:
+    case FUNC_ID_ZW_SEND_DATA_MULTI_EX:
+    case FUNC_ID_ZW_SEND_DATA_MULTI_BRIDGE:
+      compl_workbuf[0] = transaction.funcID;
+      compl_workbuf[1] = txStatus;
+      Request(transaction.cmd, compl_workbuf, 2);
+      break;
+
+    default:
+      GenerateTxStatusRequest(transaction.cmd, transaction.funcID, txStatus, txStatusReport);
+      break;
+  }
+}
+
+#define SEND_DATA_TRANSACTION_HANDLER(index)                                                 \
+  static void ZCB_SendDataTransaction##index(uint8_t txStatus, TX_STATUS_TYPE *txStatusReport) \
+  {                                                                                          \
+    SendDataTransactionComplete(index, txStatus, txStatusReport);                            \
+  }
+
+SEND_DATA_TRANSACTION_HANDLER(0)
+SEND_DATA_TRANSACTION_HANDLER(1)
+SEND_DATA_TRANSACTION_HANDLER(2)
+SEND_DATA_TRANSACTION_HANDLER(3)
+SEND_DATA_TRANSACTION_HANDLER(4)
+SEND_DATA_TRANSACTION_HANDLER(5)
+SEND_DATA_TRANSACTION_HANDLER(6)
+SEND_DATA_TRANSACTION_HANDLER(7)
+
+static const ZW_TX_Callback_t sendDataTransactionHandlers[] = {
+  ZCB_SendDataTransaction0, ZCB_SendDataTransaction1, ZCB_SendDataTransaction2, ZCB_SendDataTransaction3,
+  ZCB_SendDataTransaction4, ZCB_SendDataTransaction5, ZCB_SendDataTransaction6, ZCB_SendDataTransaction7,
+};
+
+_Static_assert(SEND_DATA_TRANSACTIONS <= sizeof_array(sendDataTransactionHandlers), "STATIC_ASSERT_SEND_DATA_TRANSACTIONS_to_big");
+
+/**
+ * Take a free entry for a send. If all are in use, an entry whose callback is overdue is taken.
+ *
+ * @param cmd Function ID of the send
+ * @param funcID funcID from the host. 0 means the host wants no callback and no entry is taken.
+ * @param pCallBack Returns the handler to use as FrameConfig.Handle, NULL if funcID is 0.
+ * @return false if all entries are in use.
+ */
+static bool SendDataTransactionOpen(uint8_t cmd, uint8_t funcID, ZW_TX_Callback_t *pCallBack)
 {
-  GenerateTxStatusRequest(FUNC_ID_ZW_SEND_DATA, funcID_ComplHandler_ZW_SendData, txStatus, txStatusReport);
+  const TickType_t now = xTaskGetTickCount();
+  uint8_t entry = SEND_DATA_TRANSACTIONS;
+
+  *pCallBack = NULL;
+  if (0 == funcID) {
+    return true;
+  }
+  for (uint8_t i = 0; (i < SEND_DATA_TRANSACTIONS) && (SEND_DATA_TRANSACTIONS == entry); i++) {
+    if (0 == sendDataTransactions[i].cmd) {
+      entry = i;
+    }
+  }
+  /* All in use: take the entry of a send whose callback should have come long ago */
+  for (uint8_t i = 0; (i < SEND_DATA_TRANSACTIONS) && (SEND_DATA_TRANSACTIONS == entry); i++) {
+    if ((now - sendDataTransactions[i].opened) >= pdMS_TO_TICKS(SEND_DATA_TRANSACTION_TIMEOUT_MS)) {
+      ZPAL_LOG_WARNING(ZPAL_LOG_APP, "%s: CMD = 0x%02X, funcID = 0x%02X never completed\r\n", __FUNCTION__,
+                       sendDataTransactions[i].cmd, sendDataTransactions[i].funcID);
+      entry = i;
+    }
+  }
+  if (SEND_DATA_TRANSACTIONS == entry) {
+    ZPAL_LOG_WARNING(ZPAL_LOG_APP, "%s: CMD = 0x%02X, no free transaction\r\n", __FUNCTION__, cmd);
+    return false;
+  }
+  sendDataTransactions[entry] = (send_data_transaction_t) {
+    .cmd = cmd,
+    .funcID = funcID,
+    .opened = now
+  };
+  *pCallBack = sendDataTransactionHandlers[entry];
+  return true;
 }
 
+/**
+ * Free the entry of a send again if it could not be put on ZwTxQueue.
+ *
+ * @param pCallBack Handler returned by SendDataTransactionOpen()
+ * @param queued Whether the send was put on ZwTxQueue
+ */
+static void SendDataTransactionQueued(ZW_TX_Callback_t pCallBack, bool queued)
+{
+  if (queued || (NULL == pCallBack)) {
+    return;
+  }
+  for (uint8_t i = 0; i < SEND_DATA_TRANSACTIONS; i++) {
+    if (sendDataTransactionHandlers[i] == pCallBack) {
+      sendDataTransactions[i].cmd = 0;
+      return;
+    }
+  }
+}
+
+void SendDataTransactionsReset(void)
+{
+  memset(sendDataTransactions, 0, sizeof(sendDataTransactions));
+}
+#else
+void SendDataTransactionsReset(void)
+{
+}
+#endif /* SEND_DATA_TRANSACTIONS_USED */
+
+#if SUPPORT_ZW_SEND_DATA
 static uint8_t SendData(uint16_t nodeID, const uint8_t *pData, uint8_t dataLength, uint8_t txOptions, ZW_TX_Callback_t pCallBack)
 {
 #ifndef ZW_SECURITY_PROTOCOL
@@ -415,31 +560,21 @@ ZW_ADD_CMD(FUNC_ID_ZW_SEND_DATA)
   assert(dataLength <= BUF_SIZE_RX);
   dataLength = MIN(dataLength, BUF_SIZE_RX);
   const uint8_t * const pSerInData = frame->payload + offset + 2;
-  funcID_ComplHandler_ZW_SendData = frame->payload[offset + 3 + dataLength];
-  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: funcID_ComplHandler_ZW_SendData = 0x%02X \r\n", __FUNCTION__, funcID_ComplHandler_ZW_SendData);
+  const uint8_t funcID = frame->payload[offset + 3 + dataLength];
+  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: funcID     = 0x%02X \r\n", __FUNCTION__, funcID);
 
-  // Create transmit frame package
-  const uint8_t retVal = SendData(nodeId, pSerInData, dataLength, frame->payload[offset + 2 + dataLength],
-                                  (funcID_ComplHandler_ZW_SendData) ? &ZCB_ComplHandler_ZW_SendData : NULL);
+  ZW_TX_Callback_t pCallBack;
+  uint8_t retVal = false;
+  if (SendDataTransactionOpen(FUNC_ID_ZW_SEND_DATA, funcID, &pCallBack)) {
+    // Create transmit frame package
+    retVal = SendData(nodeId, pSerInData, dataLength, frame->payload[offset + 2 + dataLength], pCallBack);
+    SendDataTransactionQueued(pCallBack, retVal);
+  }
   DoRespond(retVal);
 }
 #endif
 
 #if SUPPORT_ZW_SEND_DATA_EX
-uint8_t funcID_ComplHandler_ZW_SendDataEx;
-
-/*======================   ComplHandler_ZW_SendDataEx   ========================
-**    Completion handler for ZW_SendDataEx
-**
-**--------------------------------------------------------------------------*/
-static void /* RET  Nothing                     */
-ZCB_ComplHandler_ZW_SendDataEx(
-  uint8_t txStatus,
-  TX_STATUS_TYPE *txStatusReport)   /* IN   Transmit completion status  */
-{
-  GenerateTxStatusRequest(FUNC_ID_ZW_SEND_DATA_EX, funcID_ComplHandler_ZW_SendDataEx, txStatus, txStatusReport);
-}
-
 static uint8_t SendDataEx(uint16_t nodeID, uint8_t *pData, uint8_t dataLength,
                           uint8_t txOptions, uint8_t txSecOptions, uint8_t txOptions2, uint8_t secKeyType,
                           ZW_TX_Callback_t pCallBack)
@@ -478,35 +613,22 @@ ZW_ADD_CMD(FUNC_ID_ZW_SEND_DATA_EX)
   dataLength = frame->payload[offset + 1];
   assert(dataLength <= BUF_SIZE_RX);
   dataLength = MIN(dataLength, BUF_SIZE_RX);
-  funcID_ComplHandler_ZW_SendDataEx = frame->payload[offset + 6 + dataLength];
+  const uint8_t funcID = frame->payload[offset + 6 + dataLength];
 
-  const uint8_t retVal = SendDataEx(nodeId, &frame->payload[offset + 2], dataLength, frame->payload[offset + 2 + dataLength],
-                                    frame->payload[offset + 3 + dataLength], frame->payload[offset + 5 + dataLength],
-                                    frame->payload[offset + 4 + dataLength], (funcID_ComplHandler_ZW_SendDataEx != 0) ? ZCB_ComplHandler_ZW_SendDataEx : NULL);
+  ZW_TX_Callback_t pCallBack;
+  uint8_t retVal = false;
+  if (SendDataTransactionOpen(FUNC_ID_ZW_SEND_DATA_EX, funcID, &pCallBack)) {
+    retVal = SendDataEx(nodeId, &frame->payload[offset + 2], dataLength, frame->payload[offset + 2 + dataLength],
+                        frame->payload[offset + 3 + dataLength], frame->payload[offset + 5 + dataLength],
+                        frame->payload[offset + 4 + dataLength], pCallBack);
+    SendDataTransactionQueued(pCallBack, retVal);
+  }
 
   DoRespond(retVal);
 }
 #endif
 
-#if SUPPORT_ZW_SEND_DATA_MULTI || SUPPORT_ZW_SEND_DATA_MULTI_BRIDGE
-uint8_t funcID_ComplHandler_ZW_SendDataMulti;
-#endif
-
 #if SUPPORT_ZW_SEND_DATA_MULTI
-/*=====================   ComplHandler_ZW_SendDataMulti   ====================
-**    Completion handler for ZW_SendDataMulti
-**
-**--------------------------------------------------------------------------*/
-static void /* RET  Nothing                     */
-ZCB_ComplHandler_ZW_SendDataMulti(
-  uint8_t txStatus,
-  __attribute__((unused)) TX_STATUS_TYPE *txStatusType)   /* IN   Transmit completion status  */
-{
-  compl_workbuf[0] = funcID_ComplHandler_ZW_SendDataMulti;
-  compl_workbuf[1] = txStatus;
-  Request(FUNC_ID_ZW_SEND_DATA_MULTI, compl_workbuf, 2);
-}
-
 static uint8_t SendDataMulti(uint8_t numberOfNodes, const uint8_t *pNodeList, const uint8_t *pData, uint8_t dataLength, uint8_t txOptions, ZW_TX_Callback_t pCallBack)
 {
   // Create transmit frame package
@@ -539,32 +661,20 @@ ZW_ADD_CMD(FUNC_ID_ZW_SEND_DATA_MULTI)
   uint8_t numOfNodes = frame->payload[0];
   uint8_t tLength = frame->payload[1 + numOfNodes];
   uint8_t tOptions = frame->payload[2 + numOfNodes + tLength];
-  funcID_ComplHandler_ZW_SendDataMulti = frame->payload[3 + numOfNodes + tLength];
+  const uint8_t funcID = frame->payload[3 + numOfNodes + tLength];
 
-  const uint8_t retVal = SendDataMulti(numOfNodes, &frame->payload[1], &frame->payload[2 + numOfNodes], tLength, tOptions,
-                                       (funcID_ComplHandler_ZW_SendDataMulti != 0) ? &ZCB_ComplHandler_ZW_SendDataMulti : NULL);
+  ZW_TX_Callback_t pCallBack;
+  uint8_t retVal = false;
+  if (SendDataTransactionOpen(FUNC_ID_ZW_SEND_DATA_MULTI, funcID, &pCallBack)) {
+    retVal = SendDataMulti(numOfNodes, &frame->payload[1], &frame->payload[2 + numOfNodes], tLength, tOptions, pCallBack);
+    SendDataTransactionQueued(pCallBack, retVal);
+  }
 
   DoRespond(retVal);
 }
 #endif
 
 #if SUPPORT_ZW_SEND_DATA_MULTI_EX
-uint8_t funcID_ComplHandler_ZW_SendDataMultiEx;
-
-/*=====================   ComplHandler_ZW_SendDataMulti   ====================
-**    Completion handler for ZW_SendDataMulti
-**
-**--------------------------------------------------------------------------*/
-static void
-ZCB_ComplHandler_ZW_SendDataMultiEx(
-  uint8_t txStatus,   /* IN   Transmit completion status  */
-  __attribute__((unused)) TX_STATUS_TYPE* extendedTxStatus)
-{
-  compl_workbuf[0] = funcID_ComplHandler_ZW_SendDataMultiEx;
-  compl_workbuf[1] = txStatus;
-  Request(FUNC_ID_ZW_SEND_DATA_MULTI_EX, compl_workbuf, 2);
-}
-
 static uint8_t SendDataMultiEx(uint8_t dataLength, uint8_t *pData, uint8_t txOptions, uint8_t secKeyType, uint8_t groupID, ZW_TX_Callback_t pCallBack)
 {
   assert(dataLength <= BUF_SIZE_RX);
@@ -588,12 +698,17 @@ ZW_ADD_CMD(FUNC_ID_ZW_SEND_DATA_MULTI_EX)
 {
   /* dataLength | pData[] | txOptions | securityKey | groupId | funcId */
   uint8_t dataLength = frame->payload[0];
-  funcID_ComplHandler_ZW_SendDataMultiEx = frame->payload[4 + dataLength];
+  const uint8_t funcID = frame->payload[4 + dataLength];
   uint8_t tOptions = frame->payload[1 + dataLength];
   uint8_t tGID = frame->payload[3 + dataLength];
   uint8_t tKey = frame->payload[2 + dataLength];
 
-  const uint8_t retVal = SendDataMultiEx(dataLength, &frame->payload[1], tOptions, tKey, tGID, (funcID_ComplHandler_ZW_SendDataMultiEx != 0) ? ZCB_ComplHandler_ZW_SendDataMultiEx : NULL);
+  ZW_TX_Callback_t pCallBack;
+  uint8_t retVal = false;
+  if (SendDataTransactionOpen(FUNC_ID_ZW_SEND_DATA_MULTI_EX, funcID, &pCallBack)) {
+    retVal = SendDataMultiEx(dataLength, &frame->payload[1], tOptions, tKey, tGID, pCallBack);
+    SendDataTransactionQueued(pCallBack, retVal);
+  }
 
   DoRespond(retVal);
 }
@@ -624,18 +739,6 @@ ZW_ADD_CMD(FUNC_ID_ZW_SEND_DATA_ABORT)
 #endif
 
 #if SUPPORT_ZW_SEND_DATA_BRIDGE
-/*=================   ComplHandler_ZW_SendData_Bridge   ======================
-**    Completion handler for ZW_SendData_Bridge
-**
-**--------------------------------------------------------------------------*/
-static void /* RET  Nothing                     */
-ZCB_ComplHandler_ZW_SendData_Bridge(
-  uint8_t txStatus,
-  TX_STATUS_TYPE *txStatusReport)   /* IN   Transmit completion status  */
-{
-  GenerateTxStatusRequest(FUNC_ID_ZW_SEND_DATA_BRIDGE, funcID_ComplHandler_ZW_SendData, txStatus, txStatusReport);
-}
-
 static uint8_t SendDataBridge(uint16_t srcNode, uint16_t destNode, uint8_t dataLength, const uint8_t *pData, uint8_t txOptions, ZW_TX_Callback_t pCallBack)
 {
   assert(dataLength <= BUF_SIZE_RX);
@@ -665,30 +768,20 @@ ZW_ADD_CMD(FUNC_ID_ZW_SEND_DATA_BRIDGE)
   sourceNodeId = (node_id_t)GET_NODEID(&frame->payload[0], offset);
   destNodeId   = (node_id_t)GET_NODEID(&frame->payload[1 + offset], offset);
   uint8_t dataLength = frame->payload[offset + 2];
-  funcID_ComplHandler_ZW_SendData = frame->payload[offset + 3 + 1 + 4 + dataLength];
+  const uint8_t funcID = frame->payload[offset + 3 + 1 + 4 + dataLength];
   uint8_t tOptions = frame->payload[offset + 3 + dataLength];
-  const uint8_t retVal = SendDataBridge(sourceNodeId, destNodeId, dataLength, &frame->payload[offset + 3], tOptions,
-                                        (funcID_ComplHandler_ZW_SendData != 0) ? &ZCB_ComplHandler_ZW_SendData_Bridge : NULL);
+  ZW_TX_Callback_t pCallBack;
+  uint8_t retVal = false;
+  if (SendDataTransactionOpen(FUNC_ID_ZW_SEND_DATA_BRIDGE, funcID, &pCallBack)) {
+    retVal = SendDataBridge(sourceNodeId, destNodeId, dataLength, &frame->payload[offset + 3], tOptions, pCallBack);
+    SendDataTransactionQueued(pCallBack, retVal);
+  }
 
   DoRespond(retVal);
 }
 #endif
 
 #if SUPPORT_ZW_SEND_DATA_MULTI_BRIDGE
-/*================   ComplHandler_ZW_SendDataMulti_Bridge   ==================
-**    Completion handler for ZW_SendDataMulti
-**
-**--------------------------------------------------------------------------*/
-static void /* RET  Nothing                     */
-ZCB_ComplHandler_ZW_SendDataMulti_Bridge(
-  uint8_t txStatus,   /* IN   Transmit completion status  */
-  __attribute__((unused)) TX_STATUS_TYPE* extendedTxStatus)
-{
-  compl_workbuf[0] = funcID_ComplHandler_ZW_SendDataMulti;
-  compl_workbuf[1] = txStatus;
-  Request(FUNC_ID_ZW_SEND_DATA_MULTI_BRIDGE, compl_workbuf, 2);
-}
-
 static uint8_t SendDataMultiBridge(node_id_t srcNode, uint8_t numOfNodes, uint8_t *pNodeIDList,
                                    uint8_t dataLength, const uint8_t *pData, uint8_t txOptions, ZW_TX_Callback_t pCallBack)
 {
@@ -782,12 +875,16 @@ ZW_ADD_CMD(FUNC_ID_ZW_SEND_DATA_MULTI_BRIDGE)
 
   dataLength = frame->payload[offset + 2 + nodeid_list_size];
   txOptions = frame->payload[offset + 2 + 1 + nodeid_list_size + dataLength];
-  funcID_ComplHandler_ZW_SendDataMulti = frame->payload[offset + 2 + 1 + 1 + nodeid_list_size + dataLength];
+  const uint8_t funcID = frame->payload[offset + 2 + 1 + 1 + nodeid_list_size + dataLength];
   uint8_t *pDataBuf = &frame->payload[offset + 3 + nodeid_list_size];
 
-  const uint8_t retVal = SendDataMultiBridge(srcNodeId, numberNodes, pNodeList,
-                                             dataLength, pDataBuf, txOptions,
-                                             (funcID_ComplHandler_ZW_SendDataMulti != 0) ? &ZCB_ComplHandler_ZW_SendDataMulti_Bridge : NULL);
+  ZW_TX_Callback_t pCallBack;
+  uint8_t retVal = false;
+  if (SendDataTransactionOpen(FUNC_ID_ZW_SEND_DATA_MULTI_BRIDGE, funcID, &pCallBack)) {
+    retVal = SendDataMultiBridge(srcNodeId, numberNodes, pNodeList,
+                                 dataLength, pDataBuf, txOptions, pCallBack);
+    SendDataTransactionQueued(pCallBack, retVal);
+  }
 
   DoRespond(retVal);
 }
@@ -1347,6 +1444,8 @@ void /* RET  Nothing */
 ZCB_ComplHandler_ZW_NodeManagement(
   LEARN_INFO_T *statusInfo)
 {
+  /* Nodes may have been added or removed, or this controller changed role */
+  NodeListCacheInvalidate();
   if (0 == funcID_ComplHandler_ZW_NodeManagement) {
     return;
   }
@@ -2011,6 +2110,8 @@ ZCB_ComplHandler_ZW_SetSUCNodeID(
   uint8_t txStatus,   /*IN   Completion status*/
   __attribute__((unused)) TX_STATUS_TYPE *txStatusReport)
 {
+  /* The SUC capability of this controller may have changed */
+  NodeListCacheInvalidate();
   compl_workbuf[0] = funcID_ComplHandler_ZW_SetSUCNodeID;
   compl_workbuf[1] = txStatus;
   Request(FUNC_ID_ZW_SET_SUC_NODE_ID, compl_workbuf, 2);
@@ -2076,6 +2177,7 @@ void /* RET  Nothing                     */
 ZCB_ComplHandler_ZW_RemoveFailedNodeID(
   uint8_t bStatus)
 {
+  NodeListCacheInvalidate();
   if (0 == funcID_ComplHandler_ZW_RemoveFailedNodeID) {
     return;
   }
@@ -2155,6 +2257,7 @@ void /* RET  Nothing                     */
 ZCB_ComplHandler_ZW_ReplaceFailedNode(
   uint8_t bStatus)   /* IN   Transmit completion status  */
 {
+  NodeListCacheInvalidate();
   if (0 == funcID_ComplHandler_ZW_ReplaceFailedNode) {
     return;
   }
@@ -2839,6 +2942,7 @@ ZW_ADD_CMD(FUNC_ID_SERIAL_API_SET_TIMEOUTS)
 ZW_ADD_CMD(FUNC_ID_SERIAL_API_SOFT_RESET)
 {
   ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: Performing soft reset...\r\n\r\n\r\n", __FUNCTION__);
+  SerialApiNvmFlushAppData();
   //Enqueue soft reset command to protocol
   SZwaveCommandPackage Command = {
     .eCommandType = EZWAVECOMMANDTYPE_SOFT_RESET
@@ -3012,6 +3116,7 @@ ZW_ADD_CMD(FUNC_ID_ZW_AES_ECB)
 ZW_ADD_CMD(FUNC_ID_AUTO_PROGRAMMING)
 {
   //Reboot into bootloader.  Calls zpal_bootloader_reboot_and_install();
+  SerialApiNvmFlushAppData();
   SZwaveCommandPackage Command = {
     .eCommandType = EZWAVECOMMANDTYPE_BOOTLOADER_REBOOT
   };
@@ -3119,6 +3224,7 @@ ZW_ADD_CMD(FUNC_ID_ZW_ENABLE_NODE_NLS)
   volatile uint8_t offset = 0;
   node_id_t nodeId = (node_id_t)GET_NODEID(&frame->payload[0], offset);
   const uint8_t retVal = EnableNodeNLS(nodeId);
+  NodeListCacheInvalidate();
   DoRespond(retVal);
 }
 #endif
@@ -3160,6 +3266,160 @@ ZW_ADD_CMD(FUNC_ID_ZW_GET_NODE_NLS_STATE)
 }
 #endif
 
+#if SUPPORT_SERIAL_API_BATCH
+/* Length codes in the batch response for sub-commands without response payload */
+#define BATCH_NO_RESPONSE     0xFD  /* The handler sent no response */
+#define BATCH_RESPONSE_LOST   0xFE  /* The response did not fit in the batch response */
+#define BATCH_NOT_RUN         0xFF  /* No handler, or not allowed in a batch */
+
+_Static_assert(BUF_SIZE_TX < BATCH_NO_RESPONSE, "STATIC_ASSERT_BUF_SIZE_TX_to_big");
+
+/* Frame handed to the handler of each sub-command, laid out like serial_frame */
+static uint8_t batch_frame[FRAME_HEADER_LEN + RECEIVE_BUFFER_SIZE];
+static uint8_t batch_response[BUF_SIZE_TX];
+
+/* Only queries answered at once from the handler run in a batch. Anything else may reset the chip,
+   change the serial link or answer later through a callback, after the batch response. */
+static bool BatchAllowed(uint8_t cmd)
+{
+  switch (cmd) {
+    case FUNC_ID_ZW_GET_NODE_PROTOCOL_INFO:
+    case FUNC_ID_ZW_IS_FAILED_NODE_ID:
+    case FUNC_ID_ZW_GET_SUC_NODE_ID:
+    case FUNC_ID_MEMORY_GET_ID:
+    case FUNC_ID_MEMORY_GET_BYTE:
+    case FUNC_ID_MEMORY_GET_BUFFER:
+    case FUNC_ID_NVM_GET_ID:
+    case FUNC_ID_NVM_EXT_READ_LONG_BYTE:
+    case FUNC_ID_NVM_EXT_READ_LONG_BUFFER:
+    case FUNC_ID_GET_ROUTING_TABLE_LINE:
+    case FUNC_ID_ZW_GET_PRIORITY_ROUTE:
+    case FUNC_ID_ZW_GET_VERSION:
+    case FUNC_ID_ZW_GET_PROTOCOL_VERSION:
+    case FUNC_ID_ZW_TYPE_LIBRARY:
+    case FUNC_ID_ZW_IS_VIRTUAL_NODE:
+    case FUNC_ID_ZW_GET_VIRTUAL_NODES:
+    case FUNC_ID_SERIAL_API_GET_INIT_DATA:
+    case FUNC_ID_SERIAL_API_GET_LR_NODES:
+    case FUNC_ID_ZW_GET_NLS_NODES:
+    case FUNC_ID_ZW_GET_NODE_NLS_STATE:
+    case FUNC_ID_ZW_GET_CONTROLLER_CAPABILITIES:
+    case FUNC_ID_GET_LR_CHANNEL:
+    case FUNC_ID_GET_RADIO_PTI:
+    case FUNC_ID_GET_TX_TIMERS:
+    case FUNC_ID_ZW_GET_NETWORK_STATS:
+    case FUNC_ID_ZW_GET_BACKGROUND_RSSI:
+      return true;
+    default:
+      return false;
+  }
+}
+
+ZW_ADD_CMD(FUNC_ID_SERIAL_API_BATCH)
+{
+  /* HOST->ZW: { cmd | length | payload[length] } ...
+     ZW->HOST: processed | { cmd | length | payload[length] } ...
+     Sub-commands run in order through their handlers, as if sent one by one. Each one gets an entry
+     with its response, or with length BATCH_NO_RESPONSE, BATCH_RESPONSE_LOST or BATCH_NOT_RUN and no
+     payload. Running stops at a malformed entry or when the response is full; processed is the number
+     of sub-commands with an entry, so the host can send the rest again. */
+  const comm_interface_frame_ptr sub_frame = (comm_interface_frame_ptr)batch_frame;
+  const uint8_t inputLength = frame_payload_len(frame);
+  uint8_t processed = 0;
+  uint8_t i = 0;
+  uint8_t o = 1;
+
+  while (((i + 2) <= inputLength) && ((o + 2) <= BUF_SIZE_TX)) {
+    const uint8_t cmd = frame->payload[i];
+    const uint8_t length = frame->payload[i + 1];
+    uint8_t responseLength = BATCH_NOT_RUN;
+
+    if ((i + 2 + length) > inputLength) {
+      break;
+    }
+    if (BatchAllowed(cmd)) {
+      const uint8_t room = (uint8_t)(BUF_SIZE_TX - (o + 2));
+      sub_frame->sof = SOF;
+      sub_frame->len = (uint8_t)(length + 3);
+      sub_frame->type = REQUEST;
+      sub_frame->cmd = cmd;
+      memcpy(sub_frame->payload, &frame->payload[i + 2], length);
+      RespondCaptureStart(&batch_response[o + 2], room);
+      const bool invoked = invoke_cmd_handler(sub_frame);
+      const bool responded = RespondCaptureStop(&responseLength);
+      if (!invoked) {
+        responseLength = BATCH_NOT_RUN;
+      } else if (!responded) {
+        responseLength = BATCH_NO_RESPONSE;
+      } else if (responseLength > room) {
+        responseLength = BATCH_RESPONSE_LOST;
+      }
+    }
+    batch_response[o++] = cmd;
+    batch_response[o++] = responseLength;
+    if (responseLength < BATCH_NO_RESPONSE) {
+      o += responseLength;
+    }
+    i += (uint8_t)(2 + length);
+    processed++;
+    if (BATCH_RESPONSE_LOST == responseLength) {
+      break;
+    }
+  }
+  batch_response[0] = processed;
+  Respond(frame->cmd, batch_response, o);
+}
+#endif
+
+#if SUPPORT_SERIAL_API_LINK_STATS
+#define LINK_STATS_RESET  0x01
+
+ZW_ADD_CMD(FUNC_ID_SERIAL_API_LINK_STATS)
+{
+  /* HOST->ZW: [options]
+     ZW->HOST: nakSent | canSent | byteTimeouts | nakReceived | canReceived | ackTimeouts | retransmits |
+               resDropped | reqDropped | classCount | { dropped | highWater } [classCount] |
+               rxOverruns
+     Counters are 32-bit MSB first, highWater is one byte. Classes are in tx_class_t order: callback,
+     node update, application command. dropped counts Request() and RequestUnsolicited() calls
+     refused by a full class. Options bit 0 (LINK_STATS_RESET) clears
+     the counters once reported. */
+  const comm_interface_stats_t *pStats = comm_interface_stats();
+  uint8_t i = 0;
+
+  i += put_32bit_value(&compl_workbuf[i], pStats->nak_sent);
+  i += put_32bit_value(&compl_workbuf[i], pStats->can_sent);
+  i += put_32bit_value(&compl_workbuf[i], pStats->byte_timeouts);
+  i += put_32bit_value(&compl_workbuf[i], pStats->nak_received);
+  i += put_32bit_value(&compl_workbuf[i], pStats->can_received);
+  i += put_32bit_value(&compl_workbuf[i], pStats->ack_timeouts);
+  i += put_32bit_value(&compl_workbuf[i], pStats->retransmits);
+  i += put_32bit_value(&compl_workbuf[i], appLinkStats.resDropped);
+  i += put_32bit_value(&compl_workbuf[i], appLinkStats.reqDropped);
+  compl_workbuf[i++] = TX_CLASS_COUNT;
+  for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+    i += put_32bit_value(&compl_workbuf[i], tx_scheduler_dropped((tx_class_t)c));
+    compl_workbuf[i++] = tx_scheduler_high_water((tx_class_t)c);
+  }
+  i += put_32bit_value(&compl_workbuf[i], pStats->rx_overruns);
+  if ((0 < frame_payload_len(frame)) && (frame->payload[0] & LINK_STATS_RESET)) {
+    comm_interface_stats_reset();
+    tx_scheduler_stats_reset();
+    memset(&appLinkStats, 0, sizeof(appLinkStats));
+  }
+  DoRespond_workbuf(i);
+}
+#endif
+
+#if SUPPORT_SERIAL_API_LATENCY
+ZW_ADD_CMD(FUNC_ID_SERIAL_API_LATENCY)
+{
+  uint8_t length = 0;
+  func_id_serial_api_latency(frame_payload_len(frame), frame->payload, compl_workbuf, &length);
+  DoRespond_workbuf(length);
+}
+#endif
+
 // Added to make sure that capabilities is correct.
 ZW_ADD_CMD(FUNC_ID_SERIAL_API_STARTED)
 {
@@ -35,6 +35,16 @@ cmd_handler_map_t;
   static const cmd_handler_map_t cmd_handler_##cmd __attribute__((__used__, __section__(CMD_HANDLER_SECTION))) = { cmd, cmd_handler_fcn_##cmd }; \
   static void cmd_handler_fcn_##cmd(__attribute__((unused)) const comm_interface_frame_ptr frame)
 
+/* Size of the supported function ID bitmask. Bit 0 of the first byte is function ID 1. */
+#define CMD_SUPPORTED_MASK_SIZE 32
+
+/**
+ * Build the function ID lookup table from the registered command handlers.
+ *
+ * Must be called once before invoke_cmd_handler() and cmd_supported_mask().
+ */
+void cmd_handlers_init(void);
+
 /**
  * Invoke command handler.
  *
@@ -43,17 +53,16 @@ cmd_handler_map_t;
  */
 bool invoke_cmd_handler(const comm_interface_frame_ptr frame);
 
-typedef bool (*cmd_foreach_callback_t)(cmd_handler_map_t const * const p_cmd_entry, uint8_t* supported_cmds_mask);
+/**
+ * @return Bitmask of CMD_SUPPORTED_MASK_SIZE bytes with a bit set for each registered command.
+ */
+const uint8_t *cmd_supported_mask(void);
 
 /**
- * Invokes callback for each registered command.
- *
- * Will stop if the callback returns true.
- *
- * @param callback Callback function to invoke.
- * @param context Context to pass on to the callback function.
+ * Free the entries of all sends waiting for their callback. Used when the protocol has dropped its
+ * transmit queue, so those callbacks will never come.
  */
-void cmd_foreach(cmd_foreach_callback_t callback, uint8_t* supported_cmds_mask);
+void SendDataTransactionsReset(void);
 
 #ifdef ZW_CONTROLLER
 void ZCB_ComplHandler_ZW_NodeManagement(LEARN_INFO_T *statusInfo);
@@ -5,6 +5,7 @@
 
 #include "cmd_handlers.h"
 #include <assert.h>
+#include <string.h>
 
 /**
  * This is the first of the registered handlers
@@ -19,26 +20,43 @@ extern const cmd_handler_map_t __start_zw_cmd_handlers;
 extern const cmd_handler_map_t __stop_zw_cmd_handlers;
 #define cmd_handlers_stop __stop_zw_cmd_handlers
 
-bool invoke_cmd_handler(const comm_interface_frame_ptr frame)
+#define CMD_HANDLER_NONE  0xFF
+
+/* Index of the handler in the section for each function ID, CMD_HANDLER_NONE if there is none */
+static uint8_t cmd_handler_index[UINT8_MAX + 1];
+static uint8_t cmd_mask[CMD_SUPPORTED_MASK_SIZE];
+
+void cmd_handlers_init(void)
 {
+  memset(cmd_handler_index, CMD_HANDLER_NONE, sizeof(cmd_handler_index));
+  memset(cmd_mask, 0, sizeof(cmd_mask));
+
+  assert((&cmd_handlers_stop - &cmd_handlers_start) < CMD_HANDLER_NONE);
   cmd_handler_map_t const * iter = &cmd_handlers_start;
   for ( ; iter < &cmd_handlers_stop; ++iter) {
-    if (iter->cmd == frame->cmd) {
-      iter->pHandler(frame);
-      return true;
+    if (CMD_HANDLER_NONE != cmd_handler_index[iter->cmd]) {
+      // The first handler registered for a function ID is the one invoked
+      assert(false);
+      continue;
+    }
+    cmd_handler_index[iter->cmd] = (uint8_t)(iter - &cmd_handlers_start);
+    if (0 != iter->cmd) {
+      cmd_mask[(iter->cmd - 1) >> 3] |= (uint8_t)(0x1 << ((iter->cmd - 1) & 7));
     }
   }
-
-  return false;
 }
 
-void cmd_foreach(cmd_foreach_callback_t callback, uint8_t* supported_cmds_mask)
+bool invoke_cmd_handler(const comm_interface_frame_ptr frame)
 {
-  assert(callback != NULL);
-  cmd_handler_map_t const * iter = &cmd_handlers_start;
-  for ( ; iter < &cmd_handlers_stop; ++iter) {
-    if (true == callback(iter, supported_cmds_mask)) {
-      break;
-    }
+  const uint8_t index = cmd_handler_index[frame->cmd];
+  if (CMD_HANDLER_NONE == index) {
+    return false;
   }
+  (&cmd_handlers_start)[index].pHandler(frame);
+  return true;
+}
+
+const uint8_t *cmd_supported_mask(void)
+{
+  return cmd_mask;
 }
@@ -0,0 +1,226 @@
+/**
+ * @file
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#include <string.h>
+#include "sl_sleeptimer.h"
+#include "cmd_latency.h"
+#include "app.h"
+#include "utils.h"
+#include "zpal_log.h"
+
+/* Largest CMD_LATENCY_OPERATION_GET response */
+_Static_assert((10 + 2 * ((2 * CMD_LATENCY_BUCKETS) + 4)) <= BUF_SIZE_TX, "STATIC_ASSERT_CMD_LATENCY_BUCKETS_to_big");
+
+/* HOST->ZW: operation | ... */
+typedef enum {
+  CMD_LATENCY_OPERATION_GET = 0,
+  CMD_LATENCY_OPERATION_SAMPLING,
+  CMD_LATENCY_OPERATION_RESET,
+} eCmdLatencyOperation;
+
+typedef enum {
+  STAGE_IDLE = 0,
+  STAGE_PROCESSING,   // request received, waiting for the RESPONSE
+  STAGE_ACKNOWLEDGE,  // RESPONSE transmitted, waiting for the ACK
+} latency_stage_t;
+
+typedef struct {
+  uint8_t cmd;
+  uint16_t processing[CMD_LATENCY_BUCKETS];
+  uint16_t acknowledge[CMD_LATENCY_BUCKETS];
+  uint32_t processingMax;   // us
+  uint32_t acknowledgeMax;  // us
+} latency_entry_t;
+
+static latency_entry_t entry[CMD_LATENCY_ENTRIES];
+
+static struct {
+  uint8_t shift;
+  uint8_t entries;
+  uint32_t untracked;
+  uint32_t requests;
+  latency_stage_t stage;
+  uint8_t cmd;
+  uint32_t start;           // sleeptimer ticks
+} latency;
+
+static uint32_t elapsed_us(uint32_t start, uint32_t now)
+{
+  return (uint32_t)(((uint64_t)(now - start) * 1000000u) / sl_sleeptimer_get_timer_frequency());
+}
+
+static uint8_t bucket(uint32_t us)
+{
+  uint32_t v = us >> CMD_LATENCY_BUCKET_SHIFT;
+  uint8_t b = 0;
+  while (v && (b < (CMD_LATENCY_BUCKETS - 1))) {
+    v >>= 1;
+    b++;
+  }
+  return b;
+}
+
+static void count(uint16_t *pHistogram, uint32_t *pMax, uint32_t us)
+{
+  uint16_t *pBucket = &pHistogram[bucket(us)];
+  if (UINT16_MAX > *pBucket) {
+    (*pBucket)++;
+  }
+  if (us > *pMax) {
+    *pMax = us;
+  }
+}
+
+static latency_entry_t *entry_get(uint8_t cmd)
+{
+  for (uint8_t i = 0; i < latency.entries; i++) {
+    if (entry[i].cmd == cmd) {
+      return &entry[i];
+    }
+  }
+  if (CMD_LATENCY_ENTRIES > latency.entries) {
+    latency_entry_t *pEntry = &entry[latency.entries++];
+    memset(pEntry, 0, sizeof(*pEntry));
+    pEntry->cmd = cmd;
+    return pEntry;
+  }
+  return NULL;
+}
+
+uint32_t cmd_latency_timestamp(void)
+{
+  return sl_sleeptimer_get_tick_count();
+}
+
+void cmd_latency_request_received(uint8_t cmd, uint32_t timestamp)
+{
+  latency.stage = STAGE_IDLE;
+  if (CMD_LATENCY_SAMPLING_OFF == latency.shift) {
+    return;
+  }
+  if (latency.requests++ & ((1u << latency.shift) - 1)) {
+    return;
+  }
+  latency.cmd = cmd;
+  latency.start = timestamp;
+  latency.stage = STAGE_PROCESSING;
+}
+
+void cmd_latency_response_sent(uint8_t cmd)
+{
+  if ((STAGE_PROCESSING != latency.stage) || (cmd != latency.cmd)) {
+    latency.stage = STAGE_IDLE;
+    return;
+  }
+  const uint32_t now = sl_sleeptimer_get_tick_count();
+  latency_entry_t *pEntry = entry_get(cmd);
+  if (NULL == pEntry) {
+    latency.untracked++;
+    latency.stage = STAGE_IDLE;
+    return;
+  }
+  count(pEntry->processing, &pEntry->processingMax, elapsed_us(latency.start, now));
+  latency.start = now;
+  latency.stage = STAGE_ACKNOWLEDGE;
+}
+
+void cmd_latency_response_acked(void)
+{
+  if (STAGE_ACKNOWLEDGE == latency.stage) {
+    /* The entry exists, it was created when the RESPONSE was sent */
+    latency_entry_t *pEntry = entry_get(latency.cmd);
+    count(pEntry->acknowledge, &pEntry->acknowledgeMax, elapsed_us(latency.start, sl_sleeptimer_get_tick_count()));
+  }
+  latency.stage = STAGE_IDLE;
+}
+
+void cmd_latency_response_dropped(void)
+{
+  latency.stage = STAGE_IDLE;
+}
+
+bool cmd_latency_set_sampling(uint8_t shift)
+{
+  if ((CMD_LATENCY_SAMPLING_OFF != shift) && (CMD_LATENCY_SAMPLING_MAX < shift)) {
+    return false;
+  }
+  latency.shift = shift;
+  latency.requests = 0;
+  latency.stage = STAGE_IDLE;
+  return true;
+}
+
+static uint8_t put_histogram(uint8_t *pData, const uint16_t *pHistogram, uint32_t max)
+{
+  uint8_t i = 0;
+  for (uint8_t b = 0; b < CMD_LATENCY_BUCKETS; b++) {
+    pData[i++] = (uint8_t)(pHistogram[b] >> 8);
+    pData[i++] = (uint8_t)pHistogram[b];
+  }
+  i += put_32bit_value(&pData[i], max);
+  return i;
+}
+
+void func_id_serial_api_latency(uint8_t inputLength,
+                                const uint8_t *pInputBuffer,
+                                uint8_t *pOutputBuffer,
+                                uint8_t *pOutputLength)
+{
+  /**
+   * HOST->ZW: CMD_LATENCY_OPERATION_GET | index
+   * ZW->HOST: CMD_LATENCY_OPERATION_GET | entries | untracked (32-bit) | bucketShift | bucketCount | index |
+   *           [ funcID | processing[bucketCount] (16-bit) | processingMax (32-bit, us) |
+   *             acknowledge[bucketCount] (16-bit) | acknowledgeMax (32-bit, us) ]
+   *   The entry is left out if index >= entries. The host reads entries 0 to entries - 1.
+   *
+   * HOST->ZW: CMD_LATENCY_OPERATION_SAMPLING | shift (one request in 2^shift, 0xFF = off)
+   * ZW->HOST: CMD_LATENCY_OPERATION_SAMPLING | cmdRes | shift (in use)
+   *
+   * HOST->ZW: CMD_LATENCY_OPERATION_RESET
+   * ZW->HOST: CMD_LATENCY_OPERATION_RESET
+   *
+   * All values MSB first.
+   */
+  uint8_t i = 0;
+
+  if (0 == inputLength) {
+    *pOutputLength = 0;
+    return;
+  }
+  pOutputBuffer[i++] = pInputBuffer[0];
+  switch (pInputBuffer[0]) {
+    case CMD_LATENCY_OPERATION_GET:
+    {
+      const uint8_t index = (1 < inputLength) ? pInputBuffer[1] : 0;
+      pOutputBuffer[i++] = latency.entries;
+      i += put_32bit_value(&pOutputBuffer[i], latency.untracked);
+      pOutputBuffer[i++] = CMD_LATENCY_BUCKET_SHIFT;
+      pOutputBuffer[i++] = CMD_LATENCY_BUCKETS;
+      pOutputBuffer[i++] = index;
+      if (index < latency.entries) {
+        const latency_entry_t *pEntry = &entry[index];
+        pOutputBuffer[i++] = pEntry->cmd;
+        i += put_histogram(&pOutputBuffer[i], pEntry->processing, pEntry->processingMax);
+        i += put_histogram(&pOutputBuffer[i], pEntry->acknowledge, pEntry->acknowledgeMax);
+      }
+    }
+    break;
+
+    case CMD_LATENCY_OPERATION_SAMPLING:
+      pOutputBuffer[i++] = (1 < inputLength) && cmd_latency_set_sampling(pInputBuffer[1]);
+      pOutputBuffer[i++] = latency.shift;
+      break;
+
+    case CMD_LATENCY_OPERATION_RESET:
+      latency.entries = 0;
+      latency.untracked = 0;
+      latency.stage = STAGE_IDLE;
+      break;
+
+    default:
+      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: unknown operation 0x%02X\r\n", __FUNCTION__, pInputBuffer[0]);
+      break;
+  }
+  *pOutputLength = i;
+}
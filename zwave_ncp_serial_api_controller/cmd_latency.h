@@ -0,0 +1,98 @@
+/**
+ * @file
+ * Processing latency histograms per SerialAPI function ID.
+ *
+ * Two latencies are measured for each host request answered with a RESPONSE frame:
+ * - processing: from the request passing its checksum to the RESPONSE being transmitted. This
+ *   includes the time the request waits for the application task, or is kept while the NCP waits
+ *   for an ACK, and the time its handler blocks.
+ * - acknowledge: from the RESPONSE being transmitted to the host ACK.
+ *
+ * Latencies are counted in log2 buckets of microseconds. Bucket 0 holds latencies below
+ * 2^CMD_LATENCY_BUCKET_SHIFT us, bucket n the range [2^(n - 1), 2^n) times that, and the last
+ * bucket everything above. Counters saturate instead of wrapping.
+ *
+ * Function IDs get an entry when they are first measured. Once CMD_LATENCY_ENTRIES function IDs
+ * have been seen, requests of other function IDs are only counted as untracked.
+ *
+ * Only one request in 2^shift is measured, see cmd_latency_set_sampling(), so the cost of reading
+ * the timer can be kept low on a busy link.
+ *
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#ifndef _CMD_LATENCY_H_
+#define _CMD_LATENCY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Number of function IDs with histograms */
+#if !defined(CMD_LATENCY_ENTRIES)
+#define CMD_LATENCY_ENTRIES       16
+#endif
+
+/* Number of buckets per histogram */
+#if !defined(CMD_LATENCY_BUCKETS)
+#define CMD_LATENCY_BUCKETS       16
+#endif
+
+/* Upper limit of bucket 0 is 2^CMD_LATENCY_BUCKET_SHIFT us */
+#if !defined(CMD_LATENCY_BUCKET_SHIFT)
+#define CMD_LATENCY_BUCKET_SHIFT  6
+#endif
+
+/* Largest sampling shift, one request in 2^CMD_LATENCY_SAMPLING_MAX */
+#define CMD_LATENCY_SAMPLING_MAX  7
+/* Sampling shift turning measurements off */
+#define CMD_LATENCY_SAMPLING_OFF  0xFF
+
+/**
+ * @return Current time, to be taken when a request frame passes its checksum.
+ */
+uint32_t cmd_latency_timestamp(void);
+
+/**
+ * Called when a request frame is handed to the command handlers.
+ *
+ * @param cmd Function ID of the request
+ * @param timestamp cmd_latency_timestamp() when the frame passed its checksum. A frame kept while
+ *                  waiting for an ACK is handed over later, the wait is part of its latency.
+ */
+void cmd_latency_request_received(uint8_t cmd, uint32_t timestamp);
+
+/**
+ * Called when a RESPONSE frame is transmitted.
+ *
+ * @param cmd Function ID of the response
+ */
+void cmd_latency_response_sent(uint8_t cmd);
+
+/**
+ * Called when the host has acknowledged the RESPONSE frame.
+ */
+void cmd_latency_response_acked(void);
+
+/**
+ * Called when the RESPONSE frame has been given up.
+ */
+void cmd_latency_response_dropped(void);
+
+/**
+ * @param shift Measure one request in 2^shift, CMD_LATENCY_SAMPLING_OFF to stop measuring.
+ * @return false if @p shift is out of range.
+ */
+bool cmd_latency_set_sampling(uint8_t shift);
+
+/**
+ * Must be called upon receiving a "Serial API latency command".
+ * @param inputLength Length of data in input buffer.
+ * @param pInputBuffer Input buffer
+ * @param pOutputBuffer Output buffer
+ * @param pOutputLength Length of data in output buffer.
+ */
+void func_id_serial_api_latency(uint8_t inputLength,
+                                const uint8_t *pInputBuffer,
+                                uint8_t *pOutputBuffer,
+                                uint8_t *pOutputLength);
+
+#endif /* _CMD_LATENCY_H_ */
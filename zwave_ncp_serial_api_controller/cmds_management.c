@@ -7,6 +7,7 @@
 #include <cmds_management.h>
 #include <ZW_application_transport_interface.h>
 #include <utils.h>
+#include <comm_interface.h>
 #include <MfgTokens.h>
 #include <serialapi_file.h>
 #include <ZAF_Common_interface.h>
@@ -206,6 +207,17 @@ GetMaxSupportedTxPower(void)
   return ZW_TX_POWER_14DBM;
 }
 
+/**
+ * Called by comm_interface once the host has been heard on the new baud rate.
+ * Only a confirmed baud rate is saved, so a host unable to follow the switch
+ * does not lock itself out after a reset.
+ */
+static void uart_baud_rate_confirmed(uint32_t baud_rate)
+{
+  ZPAL_LOG_INFO(ZPAL_LOG_APP, "UART baud rate %u confirmed\n", (unsigned int)baud_rate);
+  SaveApplicationUartBaudRate(baud_rate);
+}
+
 void func_id_serial_api_setup(uint8_t inputLength,
                               const uint8_t *pInputBuffer,
                               uint8_t *pOutputBuffer,
@@ -266,6 +278,10 @@ void func_id_serial_api_setup(uint8_t inputLength,
       BITMASK_ADD_CMD(supportedBitmask, SERIAL_API_SETUP_CMD_TX_POWERLEVEL_GET_16_BIT);   // (19)
       BITMASK_ADD_CMD(supportedBitmask, SERIAL_API_SETUP_CMD_GET_SUPPORTED_REGION);       // (21)
       BITMASK_ADD_CMD(supportedBitmask, SERIAL_API_SETUP_CMD_GET_REGION_INFO);            // (22)
+      BITMASK_ADD_CMD(supportedBitmask, SERIAL_API_SETUP_CMD_TX_WINDOW_SET);              // (23)
+      BITMASK_ADD_CMD(supportedBitmask, SERIAL_API_SETUP_CMD_UART_BAUD_RATE_SET);         // (24)
+      BITMASK_ADD_CMD(supportedBitmask, SERIAL_API_SETUP_CMD_UART_BAUD_RATE_GET);         // (25)
+      BITMASK_ADD_CMD(supportedBitmask, SERIAL_API_SETUP_CMD_UNSOLICITED_COALESCE_SET);   // (26)
 
       /* Currently supported command with the highest value is SERIAL_API_SETUP_CMD_NODEID_BASETYPE_SET.
          No commands after it. */
@@ -570,6 +586,75 @@ void func_id_serial_api_setup(uint8_t inputLength,
     }
     break;
 
+    case SERIAL_API_SETUP_CMD_TX_WINDOW_SET:
+      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: pInputBuffer[0] = 0x%02X (SERIAL_API_SETUP_CMD_TX_WINDOW_SET)\r\n", __FUNCTION__, SERIAL_API_SETUP_CMD_TX_WINDOW_SET);
+      /**
+       *  HOST->ZW: SERIAL_API_SETUP_CMD_TX_WINDOW_SET | windowSize (0 = legacy single frame ACK protocol)
+       *  ZW->HOST: SERIAL_API_SETUP_CMD_TX_WINDOW_SET | cmdRes | windowSize (in use)
+       *
+       *  The window applies to REQUEST frames sent after this RESPONSE has been acknowledged.
+       */
+      if (SERIAL_API_SETUP_CMD_TX_WINDOW_SET_CMD_LENGTH_MIN <= inputLength) {
+        cmdRes = comm_interface_set_tx_window(pInputBuffer[1]);
+      }
+      pOutputBuffer[i++] = cmdRes;
+      pOutputBuffer[i++] = comm_interface_get_tx_window();
+      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: window size = %d\r\n", __FUNCTION__, pOutputBuffer[i-1]);
+      break;
+
+    case SERIAL_API_SETUP_CMD_UART_BAUD_RATE_SET:
+      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: pInputBuffer[0] = 0x%02X (SERIAL_API_SETUP_CMD_UART_BAUD_RATE_SET)\r\n", __FUNCTION__, SERIAL_API_SETUP_CMD_UART_BAUD_RATE_SET);
+      /**
+       *  HOST->ZW: SERIAL_API_SETUP_CMD_UART_BAUD_RATE_SET | baudRate (32-bit, MSB first)
+       *  ZW->HOST: SERIAL_API_SETUP_CMD_UART_BAUD_RATE_SET | cmdRes
+       *
+       *  The response is sent on the current baud rate. The switch takes place when the host
+       *  ACKs the response. If no valid frame is received on the new baud rate within 2 seconds
+       *  the previous baud rate is restored. The baud rate is only saved once confirmed.
+       */
+      if (SERIAL_API_SETUP_CMD_UART_BAUD_RATE_SET_CMD_LENGTH_MIN <= inputLength) {
+        uint32_t baudRate = ((uint32_t)pInputBuffer[1] << 24) | ((uint32_t)pInputBuffer[2] << 16)
+                            | ((uint32_t)pInputBuffer[3] << 8) | (uint32_t)pInputBuffer[4];
+        cmdRes = comm_interface_set_baud_rate(baudRate, uart_baud_rate_confirmed);
+      }
+      pOutputBuffer[i++] = cmdRes;
+      break;
+
+    case SERIAL_API_SETUP_CMD_UART_BAUD_RATE_GET:
+      /**
+       *  HOST->ZW: SERIAL_API_SETUP_CMD_UART_BAUD_RATE_GET
+       *  ZW->HOST: SERIAL_API_SETUP_CMD_UART_BAUD_RATE_GET | baudRate (32-bit) | count | supportedBaudRate[count] (32-bit)
+       */
+    {
+      const uint32_t *pRates;
+      uint8_t count = comm_interface_get_supported_baud_rates(&pRates);
+
+      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: pOutputBuffer[0] = 0x%02X (SERIAL_API_SETUP_CMD_UART_BAUD_RATE_GET)\r\n", __FUNCTION__, SERIAL_API_SETUP_CMD_UART_BAUD_RATE_GET);
+      i += put_32bit_value(&pOutputBuffer[i], comm_interface_get_baud_rate());
+      pOutputBuffer[i++] = count;
+      for (uint8_t j = 0; j < count; j++) {
+        i += put_32bit_value(&pOutputBuffer[i], pRates[j]);
+      }
+    }
+    break;
+
+    case SERIAL_API_SETUP_CMD_UNSOLICITED_COALESCE_SET:
+      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: pInputBuffer[0] = 0x%02X (SERIAL_API_SETUP_CMD_UNSOLICITED_COALESCE_SET)\r\n", __FUNCTION__, SERIAL_API_SETUP_CMD_UNSOLICITED_COALESCE_SET);
+      /**
+       *  HOST->ZW: SERIAL_API_SETUP_CMD_UNSOLICITED_COALESCE_SET | enable | holdTime (16-bit ms, MSB first)
+       *  ZW->HOST: SERIAL_API_SETUP_CMD_UNSOLICITED_COALESCE_SET | cmdRes
+       *
+       *  When enabled, ApplicationCommandHandler and ApplicationControllerUpdate frames requested
+       *  while the link is busy are sent as one FUNC_ID_SERIAL_API_COALESCED frame:
+       *    { length | cmd | payload[length] } ...
+       *  holdTime bounds how long a frame may wait for others, 0 only waits for the frame in flight.
+       */
+      if (SERIAL_API_SETUP_CMD_UNSOLICITED_COALESCE_SET_CMD_LENGTH_MIN <= inputLength) {
+        cmdRes = UnsolicitedCoalesceSet(0 != pInputBuffer[1], GET_16BIT_VALUE(&pInputBuffer[2]));
+      }
+      pOutputBuffer[i++] = cmdRes;
+      break;
+
     default:
       ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: pInputBuffer[0] = 0x%02X (unknown/unsupported)\r\n", __FUNCTION__, pInputBuffer[0]);
       /* HOST->ZW: [SomeUnsupportedCmd] | [SomeData] */
@@ -38,6 +38,10 @@ typedef enum {
   SERIAL_API_SETUP_CMD_TX_POWERLEVEL_GET_16_BIT   = 19,
   SERIAL_API_SETUP_CMD_GET_SUPPORTED_REGION       = 21,
   SERIAL_API_SETUP_CMD_GET_REGION_INFO            = 22,
+  SERIAL_API_SETUP_CMD_TX_WINDOW_SET              = 23,
+  SERIAL_API_SETUP_CMD_UART_BAUD_RATE_SET         = 24,
+  SERIAL_API_SETUP_CMD_UART_BAUD_RATE_GET         = 25,
+  SERIAL_API_SETUP_CMD_UNSOLICITED_COALESCE_SET   = 26,
 } eSerialAPISetupCmd;
 
 /* SERIAL_API_SETUP_CMD_NODEID_BASETYPE_SET definitions */
@@ -73,6 +77,9 @@ extern eSerialAPISetupNodeIdBaseType nodeIdBaseType;
 #define SERIAL_API_SETUP_CMD_TX_POWERLEVEL_SET_CMD_LENGTH_MIN   3
 #define SERIAL_API_SETUP_CMD_NODEID_BASETYPE_SET_CMD_LENGTH_MIN 2
 #define SERIAL_API_SETUP_CMD_MAX_LR_TX_PWR_SET_CMD_LENGTH_MIN   3
+#define SERIAL_API_SETUP_CMD_TX_WINDOW_SET_CMD_LENGTH_MIN       2
+#define SERIAL_API_SETUP_CMD_UART_BAUD_RATE_SET_CMD_LENGTH_MIN 5
+#define SERIAL_API_SETUP_CMD_UNSOLICITED_COALESCE_SET_CMD_LENGTH_MIN 4
 
 // --------------------------------
 // Definitions related to the sub command get region info
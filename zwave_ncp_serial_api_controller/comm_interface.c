@@ -13,16 +13,44 @@
 #include <assert.h>
 #include "SerialAPI_hw.h"
 #include "zpal_log.h"
+#include "binlog.h"
+#include "cmd_latency.h"
+#include "SizeOf.h"
+#include <FreeRTOS.h>
+#include <task.h>
 
-#define BUFFER_CHECK_TIME_MS    250
 #define DEFAULT_ACK_TIMEOUT_MS  1500
+#define ACK_TIMEOUT_MIN_MS      100   // floor of the adaptive ACK timeout of windowed frames
 #define DEFAULT_BYTE_TIMEOUT_MS 150
+#define DEFAULT_BAUD_RATE       115200
+#define BAUD_RATE_MAX           1000000
+#define BAUD_RATE_FALLBACK_MS   2000
 #define HEADER_LEN              4
 #define ACK_LEN                 1
 #define CRC_LEN                 1
 
+/* Host frames kept while waiting for an ACK, see handle_checksum() */
+#if !defined(COMM_INTERFACE_RX_PENDING)
+#define COMM_INTERFACE_RX_PENDING 2
+#endif
+
+/* Longest time the application task may leave the UART unread, e.g. while a handler erases flash */
+#if !defined(COMM_INTERFACE_RX_STALL_MS)
+#define COMM_INTERFACE_RX_STALL_MS  10
+#endif
+
+/* The RX ring holds what arrives at the highest baud rate while the UART is left unread (10 bits per byte).
+   It is a static buffer and the rate is negotiated at run time, so it is sized for BAUD_RATE_MAX whatever
+   rate is in use. At the default rate it holds about 85 ms. */
+#define RX_STALL_BYTES          ((BAUD_RATE_MAX / 10000) * COMM_INTERFACE_RX_STALL_MS)
+
 #define COMM_INT_TX_BUFFER_SIZE RECEIVE_BUFFER_SIZE
-#define COMM_INT_RX_BUFFER_SIZE RECEIVE_BUFFER_SIZE
+#define COMM_INT_RX_BUFFER_SIZE ((RX_STALL_BYTES > RECEIVE_BUFFER_SIZE) ? RX_STALL_BYTES : RECEIVE_BUFFER_SIZE)
+
+/* RTS is deasserted through SerialAPI_set_rts() while the RX ring is more than 3/4 full and asserted
+   again once it has been read down to 1/4 */
+#define RX_RTS_OFF_LEVEL        ((COMM_INT_RX_BUFFER_SIZE * 3) / 4)
+#define RX_RTS_ON_LEVEL         (COMM_INT_RX_BUFFER_SIZE / 4)
 #define TRANSMIT_BUFFER_SIZE    COMM_INT_TX_BUFFER_SIZE
 
 typedef enum {
@@ -32,33 +60,54 @@ typedef enum {
   COMM_INTERFACE_STATE_CMD      = 3,
   COMM_INTERFACE_STATE_DATA     = 4,
   COMM_INTERFACE_STATE_CHECKSUM = 5,
+  COMM_INTERFACE_STATE_ACK_SEQ  = 6,
 } comm_interface_state_t;
 
 typedef struct {
   transport_t transport;
   SSwTimer ack_timer;
   bool ack_timeout;
-  uint32_t ack_timeout_ms;
+  uint32_t ack_timeout_ms;        // configured, ceiling of ack_rto_ms
+  uint32_t ack_rto_ms;            // ACK timeout in use, derived from the measured round trip time
+  uint32_t srtt_ms;               // smoothed ACK round trip time, 0 until measured
+  uint32_t rttvar_ms;             // round trip time variation
+  const uint8_t *rtt_frame;       // frame whose ACK is being timed, NULL if none
+  TickType_t rtt_start;
   SSwTimer byte_timer;
   bool byte_timeout;
   uint32_t byte_timeout_ms;
-  SSwTimer buffer_check_timer;
   comm_interface_state_t state;
-  uint8_t expect_bytes;
+  volatile uint8_t expect_bytes;  // bytes receive_callback() waits for, 0 once notified
   bool ack_needed;
   uint8_t buffer_len;
   uint8_t buffer[RECEIVE_BUFFER_SIZE];
   bool rx_active;
   uint8_t rx_wait_count;
+  uint8_t rx_chunk_len;           // bytes pulled from the UART into rx_chunk
+  uint8_t rx_chunk_pos;           // bytes of rx_chunk already parsed
+  SSwTimer baud_rate_timer;
+  uint32_t baud_rate;
+  uint32_t baud_rate_previous;
+  uint32_t baud_rate_pending;     // requested, latched by the next transmitted frame
+  uint32_t baud_rate_on_ack;      // switched to when the frame in flight is acknowledged
+  bool baud_rate_probing;         // waiting for a valid frame at the new rate
+  baud_rate_confirmed_cb_t baud_rate_cb;
+  volatile bool rts_stopped;      // RTS deasserted, the host must stop sending
 } comm_interface_t;
 
 typedef struct {
-  uint8_t sof;
-  uint8_t len;
-  uint8_t type;
-  uint8_t cmd;
-  uint8_t payload[UINT8_MAX];
-} tx_frame_t;
+  const uint8_t *frame;  // type byte holds REQUEST with the sequence number in the upper nibble
+  uint8_t tag;
+} tx_window_entry_t;
+
+typedef struct {
+  uint8_t size;       // 0: legacy protocol, one frame in flight
+  uint8_t next_seq;
+  uint8_t head;       // oldest frame in the window
+  uint8_t count;      // frames in the window, including acknowledged ones not yet popped
+  uint8_t acked;      // frames at head acknowledged (or aborted) but not yet popped
+  tx_window_entry_t entry[TX_WINDOW_SIZE_MAX];
+} tx_window_t;
 
 static comm_interface_t comm_interface = {
   .transport.type = TRANSPORT_TYPE_UART,
@@ -66,28 +115,81 @@ static comm_interface_t comm_interface = {
   .buffer_len = 0,
 };
 
-comm_interface_frame_ptr const serial_frame = (comm_interface_frame_ptr)comm_interface.buffer;
+/* Frame being received */
+static comm_interface_frame_ptr const rx_frame = (comm_interface_frame_ptr)comm_interface.buffer;
+comm_interface_frame_ptr serial_frame = (comm_interface_frame_ptr)comm_interface.buffer;
+
+/* Host frames received while waiting for an ACK, handed out by the next comm_interface_parse_data(true) */
+static struct {
+  uint8_t head;
+  uint8_t count;
+  bool delivered;     // the frame at head is serial_frame, freed by the next comm_interface_parse_data()
+  uint8_t frame[COMM_INTERFACE_RX_PENDING][RECEIVE_BUFFER_SIZE];
+  uint32_t timestamp[COMM_INTERFACE_RX_PENDING];
+} rx_pending;
+
+/* cmd_latency_timestamp() when rx_frame passed its checksum */
+static uint32_t rx_frame_timestamp;
+
+static tx_window_t tx_window = { 0 };
+
+static comm_interface_stats_t stats = { 0 };
+
+static const uint32_t supported_baud_rates[] = { 115200, 230400, 460800, 921600, BAUD_RATE_MAX };
 
 static uint8_t tx_data[COMM_INT_TX_BUFFER_SIZE];
+/* Frames passed as payload + length are built here, queued frames are sent in place */
+static uint8_t response_frame[FRAME_BUFFER_SIZE(UINT8_MAX)];
+/* Frame retransmitted on NAK/timeout in the legacy protocol */
+static const uint8_t *last_frame = NULL;
 static uint8_t rx_data[COMM_INT_RX_BUFFER_SIZE];
+static uint8_t rx_chunk[RECEIVE_BUFFER_SIZE];
+
+static void rts_set(bool ready)
+{
+  comm_interface.rts_stopped = !ready;
+  SerialAPI_set_rts(ready);
+}
+
+static uint8_t rx_chunk_remaining(void)
+{
+  return comm_interface.rx_chunk_len - comm_interface.rx_chunk_pos;
+}
 
+/**
+ * Wake the application task once @p level bytes can be parsed.
+ *
+ * The threshold is armed before the UART is looked at, so a byte received in between is seen
+ * either by receive_callback() or by the check below and no critical section is needed. A byte
+ * seen by both only notifies twice.
+ */
 static void set_expect_bytes(uint8_t level)
 {
-  vPortEnterCritical();
+  /* Bytes already pulled from the UART but not parsed yet count as received */
+  uint8_t buffered = rx_chunk_remaining();
 
-  if (zpal_uart_get_available(comm_interface.transport.handle) >= level) {
+  if (buffered >= level) {
+    comm_interface.expect_bytes = 0;
+    TriggerNotification(EAPPLICATIONEVENT_SERIALDATARX);
+    return;
+  }
+  comm_interface.expect_bytes = level - buffered;
+  if (zpal_uart_get_available(comm_interface.transport.handle) >= (size_t)(level - buffered)) {
     comm_interface.expect_bytes = 0;
     TriggerNotification(EAPPLICATIONEVENT_SERIALDATARX);
-  } else {
-    comm_interface.expect_bytes = level;
   }
-
-  vPortExitCritical();
 }
 
+/**
+ * Notifies once per threshold: the next parse pass arms a new one with set_expect_bytes(),
+ * so the application task is not woken for every byte of a frame.
+ */
 static void receive_callback(__attribute__((unused)) const zpal_uart_handle_t handle, size_t available)
 {
-  if (available >= comm_interface.expect_bytes) {
+  if ((available >= RX_RTS_OFF_LEVEL) && !comm_interface.rts_stopped) {
+    rts_set(false);
+  }
+  if (comm_interface.expect_bytes && (available >= comm_interface.expect_bytes)) {
     comm_interface.expect_bytes = 0;
     TriggerNotification(EAPPLICATIONEVENT_SERIALDATARX);
   }
@@ -99,16 +201,110 @@ static void ack_timer_cb(__attribute__((unused)) SSwTimer *timer)
   TriggerNotification(EAPPLICATIONEVENT_SERIALTIMEOUT);
 }
 
+/**
+ * Time the ACK of a frame transmitted for the first time. Only one frame is timed at once and
+ * retransmitted frames are never timed, as their ACK cannot be matched to a transmission.
+ */
+static void rtt_start(const uint8_t *frame)
+{
+  if (NULL == comm_interface.rtt_frame) {
+    comm_interface.rtt_frame = frame;
+    comm_interface.rtt_start = xTaskGetTickCount();
+  }
+}
+
+/**
+ * Update the round trip time estimate with the ACK of the timed frame and derive the ACK timeout
+ * from it: smoothed RTT + 4 * RTT variation, between ACK_TIMEOUT_MIN_MS and the configured timeout.
+ */
+static void rtt_sample(void)
+{
+  uint32_t rtt = (uint32_t)(xTaskGetTickCount() - comm_interface.rtt_start) * portTICK_PERIOD_MS;
+  uint32_t rto;
+
+  comm_interface.rtt_frame = NULL;
+  if (0 == comm_interface.srtt_ms) {
+    comm_interface.srtt_ms = rtt ? rtt : 1;
+    comm_interface.rttvar_ms = rtt / 2;
+  } else {
+    uint32_t delta = (comm_interface.srtt_ms > rtt) ? (comm_interface.srtt_ms - rtt) : (rtt - comm_interface.srtt_ms);
+    comm_interface.rttvar_ms = (3 * comm_interface.rttvar_ms + delta) / 4;
+    comm_interface.srtt_ms = (7 * comm_interface.srtt_ms + rtt) / 8;
+    if (0 == comm_interface.srtt_ms) {
+      comm_interface.srtt_ms = 1;
+    }
+  }
+  rto = comm_interface.srtt_ms + 4 * comm_interface.rttvar_ms;
+  if (rto < ACK_TIMEOUT_MIN_MS) {
+    rto = ACK_TIMEOUT_MIN_MS;
+  }
+  if (rto > comm_interface.ack_timeout_ms) {
+    rto = comm_interface.ack_timeout_ms;
+  }
+  comm_interface.ack_rto_ms = rto;
+}
+
 static void byte_timer_cb(__attribute__((unused)) SSwTimer *timer)
 {
   comm_interface.byte_timeout = true;
   TriggerNotification(EAPPLICATIONEVENT_SERIALTIMEOUT);
 }
 
-static void buffer_check_timer_cb(__attribute__((unused)) SSwTimer *timer)
+static void uart_open(uint32_t baud_rate)
 {
-  if (zpal_uart_get_available(comm_interface.transport.handle)) {
-    TriggerNotification(EAPPLICATIONEVENT_SERIALDATARX);
+  const zpal_uart_config_t uart_config =
+  {
+    .tx_buffer = tx_data,
+    .tx_buffer_len = COMM_INT_TX_BUFFER_SIZE,
+    .rx_buffer = rx_data,
+    .rx_buffer_len = COMM_INT_RX_BUFFER_SIZE,
+    .id = ZPAL_UART0,
+    .baud_rate = baud_rate,
+    .data_bits = 8,
+    .parity_bit = ZPAL_UART_NO_PARITY,
+    .stop_bits = ZPAL_UART_STOP_BITS_1,
+    .receive_callback = receive_callback,
+    .ptr = SerialAPI_get_uart_config_ext(),
+  };
+
+  __attribute__((unused)) zpal_status_t status = zpal_uart_init(&uart_config, &comm_interface.transport.handle);
+  assert(status == ZPAL_STATUS_OK);
+  status = zpal_uart_enable(comm_interface.transport.handle);
+  assert(status == ZPAL_STATUS_OK);
+  rts_set(true);
+  comm_interface.baud_rate = baud_rate;
+}
+
+static void switch_baud_rate(uint32_t baud_rate)
+{
+  ZPAL_LOG_INFO(ZPAL_LOG_APP, "%s: %u -> %u\r\n", __FUNCTION__, comm_interface.baud_rate, baud_rate);
+  comm_interface_wait_transmit_done();
+  zpal_uart_disable(comm_interface.transport.handle);
+  uart_open(baud_rate);
+  comm_interface.state = COMM_INTERFACE_STATE_SOF;
+  comm_interface.rx_active = false;
+  /* Anything still buffered was received at the old rate */
+  comm_interface.rx_chunk_len = 0;
+  comm_interface.rx_chunk_pos = 0;
+}
+
+static void baud_rate_timer_cb(__attribute__((unused)) SSwTimer *timer)
+{
+  if (comm_interface.baud_rate_probing) {
+    /* Nothing valid heard from the host at the new rate, go back to the previous one */
+    comm_interface.baud_rate_probing = false;
+    switch_baud_rate(comm_interface.baud_rate_previous);
+  }
+}
+
+static void apply_baud_rate_on_ack(void)
+{
+  if (comm_interface.baud_rate_on_ack) {
+    comm_interface.baud_rate_previous = comm_interface.baud_rate;
+    switch_baud_rate(comm_interface.baud_rate_on_ack);
+    comm_interface.baud_rate_on_ack = 0;
+    comm_interface.baud_rate_probing = true;
+    TimerStart(&comm_interface.baud_rate_timer, BAUD_RATE_FALLBACK_MS);
   }
 }
 
@@ -138,86 +334,182 @@ static zpal_status_t comm_interface_transmit(transport_t *transport, const uint8
   return ZPAL_STATUS_FAIL;
 }
 
-void comm_interface_transmit_frame(uint8_t cmd, uint8_t type, const uint8_t *payload, uint8_t len, transmit_done_cb_t cb)
+static void transmit_window_entry(const tx_window_entry_t *entry)
 {
-  tx_frame_t frame = {
-    .sof = SOF
-  };
-  static uint8_t _len, _type, _cmd, _checksum;
-  static const uint8_t *_payload;
+  comm_interface_transmit(&comm_interface.transport, entry->frame, FRAME_TOTAL_LEN(entry->frame), NULL);
+}
+
+bool comm_interface_set_tx_window(uint8_t size)
+{
+  if (tx_window.count) {
+    return false;
+  }
+  tx_window.size = (size > TX_WINDOW_SIZE_MAX) ? TX_WINDOW_SIZE_MAX : size;
+  tx_window.next_seq = 0;
+  tx_window.head = 0;
+  tx_window.acked = 0;
+  return true;
+}
+
+uint8_t comm_interface_get_tx_window(void)
+{
+  return tx_window.size;
+}
+
+bool comm_interface_tx_window_full(void)
+{
+  return (tx_window.count >= tx_window.size);
+}
+
+uint8_t comm_interface_tx_window_outstanding(void)
+{
+  return tx_window.count - tx_window.acked;
+}
 
+void comm_interface_transmit_window_frame(uint8_t *frame, uint8_t tag)
+{
+  assert(!comm_interface_tx_window_full());
+  tx_window_entry_t *entry = &tx_window.entry[(tx_window.head + tx_window.count) % TX_WINDOW_SIZE_MAX];
+  uint8_t type = REQUEST | (uint8_t)(tx_window.next_seq << TX_WINDOW_SEQ_SHIFT);
+
+  /* Stamp the sequence number in place, the checksum only needs the type byte difference */
+  frame[FRAME_TOTAL_LEN(frame) - FRAME_CHECKSUM_LEN] ^= (uint8_t)(frame[FRAME_TYPE_IDX] ^ type);
+  frame[FRAME_TYPE_IDX] = type;
+  entry->frame = frame;
+  entry->tag = tag;
+  tx_window.next_seq = (tx_window.next_seq + 1) & TX_WINDOW_SEQ_MASK;
+  tx_window.count++;
+
+  comm_interface.ack_needed = true;
+  set_expect_bytes(ACK_LEN);
+  transmit_window_entry(entry);
+  rtt_start(frame);
+  /* The ACK timer guards the oldest frame in flight */
+  if (!TimerIsActive(&comm_interface.ack_timer)) {
+    comm_interface.ack_timeout = false;
+    TimerStart(&comm_interface.ack_timer, comm_interface.ack_rto_ms);
+  }
+}
+
+bool comm_interface_tx_window_pop_acked(uint8_t *tag)
+{
+  if (0 == tx_window.acked) {
+    return false;
+  }
+  *tag = tx_window.entry[tx_window.head].tag;
+  tx_window.head = (tx_window.head + 1) % TX_WINDOW_SIZE_MAX;
+  tx_window.count--;
+  tx_window.acked--;
+  return true;
+}
+
+void comm_interface_tx_window_abort(void)
+{
+  tx_window.acked = tx_window.count;
+  comm_interface.rtt_frame = NULL;
+  comm_interface.ack_needed = false;
+  comm_interface.ack_timeout = false;
+  TimerStop(&comm_interface.ack_timer);
+}
+
+uint8_t comm_interface_frame_build(uint8_t *frame, uint8_t cmd, uint8_t type, uint8_t len)
+{
+  frame[FRAME_SOF_IDX] = SOF;
+  frame[FRAME_LEN_IDX] = len + 3;
+  frame[FRAME_TYPE_IDX] = type;
+  frame[FRAME_CMD_IDX] = cmd;
+  frame[FRAME_HEADER_LEN + len] = xor_checksum(0xFF, &frame[FRAME_LEN_IDX], frame[FRAME_LEN_IDX]);
+  return FRAME_BUFFER_SIZE(len);
+}
+
+static void transmit_prepare(void)
+{
   TimerStop(&comm_interface.ack_timer);
   TimerStop(&comm_interface.byte_timer);
-  TimerStop(&comm_interface.buffer_check_timer);
 
   comm_interface.byte_timeout = false;
   comm_interface.ack_timeout = false;
+}
 
-  if (payload != NULL) {
-    frame.len = len + 3;
-    frame.type = type;
-    frame.cmd = cmd;
-    memcpy(frame.payload, payload, len);
-    frame.payload[len] = xor_checksum(0xFF, &frame.len, frame.len);
-
-    /* store input arguments for retransmission */
-    _len = len;
-    _type = type;
-    _cmd = cmd;
-    _payload = payload;
-    _checksum = frame.payload[len];
-  } else {
-    /* retransmit last frame */
-    frame.len = _len + 3;
-    frame.type = _type;
-    frame.cmd = _cmd;
-    if (_payload) {
-      memcpy(frame.payload, _payload, _len);
+/* Frames without a sequence number wait for the configured timeout, not the adaptive one. The host
+   cannot tell a retransmission of one from a new frame, so an ACK that is only late must not cause it. */
+static void transmit_await_ack(const uint8_t *frame, transmit_done_cb_t cb)
+{
+  comm_interface.ack_needed = true;
+  set_expect_bytes(ACK_LEN);
+  if (frame) {
+    comm_interface_transmit(&comm_interface.transport, frame, FRAME_TOTAL_LEN(frame), cb);
+  }
+  TimerStart(&comm_interface.ack_timer, comm_interface.ack_timeout_ms);
+}
+
+void comm_interface_transmit_framed(const uint8_t *frame, transmit_done_cb_t cb)
+{
+  transmit_prepare();
+
+  /* A requested baud rate change takes effect when this frame is acknowledged */
+  comm_interface.baud_rate_on_ack = comm_interface.baud_rate_pending;
+  comm_interface.baud_rate_pending = 0;
+
+  last_frame = frame;
+  comm_interface.rtt_frame = NULL;
+  rtt_start(frame);
+  transmit_await_ack(frame, cb);
+}
+
+static void retransmit(transmit_done_cb_t cb)
+{
+  stats.retransmits++;
+  transmit_prepare();
+  comm_interface.rtt_frame = NULL;
+
+  if (comm_interface_tx_window_outstanding()) {
+    /* Go back N: retransmit every windowed frame not yet acknowledged */
+    comm_interface.ack_needed = true;
+    set_expect_bytes(ACK_LEN);
+    for (uint8_t i = tx_window.acked; i < tx_window.count; i++) {
+      transmit_window_entry(&tx_window.entry[(tx_window.head + i) % TX_WINDOW_SIZE_MAX]);
     }
-    frame.payload[_len] = _checksum;
+    TimerStart(&comm_interface.ack_timer, comm_interface.ack_rto_ms);
+    return;
   }
 
-  comm_interface.ack_needed = true;
-  set_expect_bytes(ACK_LEN);
-  comm_interface_transmit(&comm_interface.transport, (uint8_t *)&frame, frame.len + 2, cb);
-  TimerStart(&comm_interface.ack_timer, comm_interface_get_ack_timeout_ms());
-  TimerStart(&comm_interface.buffer_check_timer, BUFFER_CHECK_TIME_MS);
+  /* retransmit last frame, straight from where it was built */
+  transmit_await_ack(last_frame, cb);
+}
+
+void comm_interface_transmit_frame(uint8_t cmd, uint8_t type, const uint8_t *payload, uint8_t len, transmit_done_cb_t cb)
+{
+  if (payload != NULL) {
+    memcpy(FRAME_PAYLOAD(response_frame), payload, len);
+    comm_interface_frame_build(response_frame, cmd, type, len);
+    comm_interface_transmit_framed(response_frame, cb);
+    return;
+  }
+
+  retransmit(cb);
 }
 
 /////////////////////////////////////////////////////////////////////////////////
 /// MAB 2025.10.13
 /// This would appear to be a blocking routine, i.e. hogs the CPU.
-/// However, this routine is never called.
+/// Only used before a baud rate switch, when at most a few bytes are pending.
 /////////////////////////////////////////////////////////////////////////////////
 void comm_interface_wait_transmit_done(void)
 {
   while (zpal_uart_transmit_in_progress(comm_interface.transport.handle));
 }
 
-void comm_interface_init(void)
+void comm_interface_init(uint32_t baud_rate)
 {
-  const zpal_uart_config_t uart_config =
-  {
-    .tx_buffer = tx_data,
-    .tx_buffer_len = COMM_INT_TX_BUFFER_SIZE,
-    .rx_buffer = rx_data,
-    .rx_buffer_len = COMM_INT_RX_BUFFER_SIZE,
-    .id = ZPAL_UART0,
-    .baud_rate = 115200,
-    .data_bits = 8,
-    .parity_bit = ZPAL_UART_NO_PARITY,
-    .stop_bits = ZPAL_UART_STOP_BITS_1,
-    .receive_callback = receive_callback,
-    .ptr = SerialAPI_get_uart_config_ext(),
-  };
-
   comm_interface_set_ack_timeout_ms(DEFAULT_ACK_TIMEOUT_MS);
   comm_interface_set_byte_timeout_ms(DEFAULT_BYTE_TIMEOUT_MS);
 
-  __attribute__((unused)) zpal_status_t status = zpal_uart_init(&uart_config, &comm_interface.transport.handle);
-  assert(status == ZPAL_STATUS_OK);
-  status = zpal_uart_enable(comm_interface.transport.handle);
-  assert(status == ZPAL_STATUS_OK);
+  bool supported = false;
+  for (uint8_t i = 0; i < sizeof_array(supported_baud_rates); i++) {
+    supported |= (supported_baud_rates[i] == baud_rate);
+  }
+  uart_open(supported ? baud_rate : DEFAULT_BAUD_RATE);
 
   AppTimerRegister(&comm_interface.ack_timer, false, ack_timer_cb);
   TimerStop(&comm_interface.ack_timer);
@@ -225,8 +517,8 @@ void comm_interface_init(void)
   AppTimerRegister(&comm_interface.byte_timer, false, byte_timer_cb);
   TimerStop(&comm_interface.byte_timer);
 
-  AppTimerRegister(&comm_interface.buffer_check_timer, true, buffer_check_timer_cb);
-  TimerStop(&comm_interface.buffer_check_timer);
+  AppTimerRegister(&comm_interface.baud_rate_timer, false, baud_rate_timer_cb);
+  TimerStop(&comm_interface.baud_rate_timer);
 
   set_expect_bytes(HEADER_LEN);
 }
@@ -239,6 +531,25 @@ uint32_t comm_interface_get_ack_timeout_ms(void)
 void comm_interface_set_ack_timeout_ms(uint32_t t)
 {
   comm_interface.ack_timeout_ms = t;
+  /* Start over from the ceiling, the estimate is rebuilt from the next ACKs */
+  comm_interface.ack_rto_ms = t;
+  comm_interface.srtt_ms = 0;
+  comm_interface.rttvar_ms = 0;
+}
+
+uint32_t comm_interface_get_ack_rto_ms(void)
+{
+  return comm_interface.ack_rto_ms;
+}
+
+const comm_interface_stats_t *comm_interface_stats(void)
+{
+  return &stats;
+}
+
+void comm_interface_stats_reset(void)
+{
+  memset(&stats, 0, sizeof(stats));
 }
 
 uint32_t comm_interface_get_byte_timeout_ms(void)
@@ -251,15 +562,81 @@ void comm_interface_set_byte_timeout_ms(uint32_t t)
   comm_interface.byte_timeout_ms = t;
 }
 
-static void store_byte(uint8_t byte)
+bool comm_interface_set_baud_rate(uint32_t baud_rate, baud_rate_confirmed_cb_t cb)
+{
+  for (uint8_t i = 0; i < sizeof_array(supported_baud_rates); i++) {
+    if (supported_baud_rates[i] == baud_rate) {
+      comm_interface.baud_rate_pending = (baud_rate != comm_interface.baud_rate) ? baud_rate : 0;
+      comm_interface.baud_rate_cb = cb;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t comm_interface_get_baud_rate(void)
+{
+  return comm_interface.baud_rate;
+}
+
+uint8_t comm_interface_get_supported_baud_rates(const uint32_t **rates)
+{
+  *rates = supported_baud_rates;
+  return sizeof_array(supported_baud_rates);
+}
+
+/**
+ * (Re)arm the inter-byte timer. Called once per chunk pulled from the UART
+ * while a frame is being received, not once per byte.
+ */
+static void byte_timer_kick(void)
 {
   if (TimerIsActive(&comm_interface.byte_timer)) {
     TimerRestart(&comm_interface.byte_timer);
   } else {
     TimerStart(&comm_interface.byte_timer, comm_interface_get_byte_timeout_ms());
   }
-
   comm_interface.byte_timeout = false;
+}
+
+/**
+ * Pull everything the UART driver has buffered in one call.
+ *
+ * @return true if there is at least one unparsed byte in rx_chunk.
+ */
+static bool rx_chunk_fill(void)
+{
+  if (rx_chunk_remaining()) {
+    return true;
+  }
+  comm_interface.rx_chunk_pos = 0;
+  comm_interface.rx_chunk_len = 0;
+
+  size_t available = zpal_uart_get_available(comm_interface.transport.handle);
+  if (0 == available) {
+    return false;
+  }
+  if (available >= COMM_INT_RX_BUFFER_SIZE) {
+    /* Bytes arriving now are lost */
+    stats.rx_overruns++;
+  }
+  if (available > sizeof(rx_chunk)) {
+    available = sizeof(rx_chunk);
+  }
+  comm_interface.rx_chunk_len = (uint8_t)zpal_uart_receive(comm_interface.transport.handle, rx_chunk, available);
+  if (comm_interface.rts_stopped
+      && (zpal_uart_get_available(comm_interface.transport.handle) <= RX_RTS_ON_LEVEL)) {
+    rts_set(true);
+  }
+
+  if (comm_interface.rx_active) {
+    byte_timer_kick();
+  }
+  return (comm_interface.rx_chunk_len > 0);
+}
+
+static void store_byte(uint8_t byte)
+{
   comm_interface.buffer[comm_interface.buffer_len] = byte;
   comm_interface.buffer_len++;
 }
@@ -269,62 +646,102 @@ static comm_interface_parse_result_t handle_sof(uint8_t input)
   comm_interface_parse_result_t result = PARSE_IDLE;
 
   if (input == SOF) {
-    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = SOF\r\n", __FUNCTION__);
+    BINLOG_DEBUG("%s: rx_byte = SOF\r\n", __FUNCTION__);
     comm_interface.state = COMM_INTERFACE_STATE_LEN;
-    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_LEN\r\n", __FUNCTION__);
+    BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_LEN\r\n", __FUNCTION__);
     comm_interface.buffer_len = 0;
     comm_interface.rx_active = true; // now we're receiving - check for timeout
+    byte_timer_kick();
     store_byte(input);
   } else {
-    if (comm_interface.ack_needed) {
+    if (comm_interface.ack_needed && (input == ACK) && comm_interface_tx_window_outstanding()) {
+      /* Cumulative ACK, the sequence number follows */
+      comm_interface.state = COMM_INTERFACE_STATE_ACK_SEQ;
+    } else if (comm_interface.ack_needed) {
       if ((input == ACK) || (input == NAK)) {
         comm_interface.ack_needed = false; // Done
         comm_interface.ack_timeout = false;
         comm_interface.byte_timeout = false;
         TimerStop(&comm_interface.ack_timer);
         TimerStop(&comm_interface.byte_timer);
-        TimerStop(&comm_interface.buffer_check_timer);
       }
       if (input == ACK) {
-        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = ACK\r\n", __FUNCTION__);
+        BINLOG_DEBUG("%s: rx_byte = ACK\r\n", __FUNCTION__);
+        if (comm_interface.rtt_frame) {
+          rtt_sample();
+        }
+        apply_baud_rate_on_ack();
         result = PARSE_FRAME_SENT;
       } else if (input == NAK) {
-          ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = NAK\r\n", __FUNCTION__);
-        result = PARSE_TX_TIMEOUT;
+          BINLOG_DEBUG("%s: rx_byte = NAK\r\n", __FUNCTION__);
+        stats.nak_received++;
+        result = PARSE_TX_NAK;
+      } else if (input == CAN) {
+        stats.can_received++;
+        BINLOG_DEBUG("%s: rx_byte = CAN\r\n", __FUNCTION__);
       } else {
         // Bogus character received...
-          ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
+          BINLOG_DEBUG("%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
       }
     } else {
       if (isprint(input))
         {
-          ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X \t %c\r\n", __FUNCTION__, input, input);
+          BINLOG_DEBUG("%s: rx_byte = 0x%02X \t %c\r\n", __FUNCTION__, input, input);
         }
       else
         {
-          ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
+          BINLOG_DEBUG("%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
         }
       comm_interface.ack_timeout = false;
       TimerStop(&comm_interface.ack_timer);
-      TimerStop(&comm_interface.buffer_check_timer);
     }
   }
   return result;
 }
 
+static comm_interface_parse_result_t handle_ack_seq(uint8_t input)
+{
+  uint8_t outstanding = comm_interface_tx_window_outstanding();
+
+  comm_interface.state = COMM_INTERFACE_STATE_SOF;
+  BINLOG_DEBUG("%s: rx_byte = 0x%02X (ACK sequence)\r\n", __FUNCTION__, input);
+  for (uint8_t i = 0; i < outstanding; i++) {
+    const tx_window_entry_t *entry = &tx_window.entry[(tx_window.head + tx_window.acked + i) % TX_WINDOW_SIZE_MAX];
+    if ((entry->frame[FRAME_TYPE_IDX] >> TX_WINDOW_SEQ_SHIFT) == (input & TX_WINDOW_SEQ_MASK)) {
+      /* All frames up to and including this one have been received by the host */
+      for (uint8_t j = 0; (j <= i) && comm_interface.rtt_frame; j++) {
+        if (tx_window.entry[(tx_window.head + tx_window.acked + j) % TX_WINDOW_SIZE_MAX].frame == comm_interface.rtt_frame) {
+          rtt_sample();
+        }
+      }
+      tx_window.acked += i + 1;
+      comm_interface.ack_timeout = false;
+      TimerStop(&comm_interface.ack_timer);
+      if (comm_interface_tx_window_outstanding()) {
+        TimerStart(&comm_interface.ack_timer, comm_interface.ack_rto_ms);
+      } else {
+        comm_interface.ack_needed = false;
+      }
+      return PARSE_FRAME_SENT;
+    }
+  }
+  /* Stale or bogus sequence number, keep waiting */
+  return PARSE_IDLE;
+}
+
 static void handle_len(uint8_t input)
 {
-  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
+  BINLOG_DEBUG("%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
   // Check for length to be inside valid range
   if ((input < FRAME_LENGTH_MIN) || (input > FRAME_LENGTH_MAX)) {
     comm_interface.state = COMM_INTERFACE_STATE_SOF; // Restart looking for SOF
-    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
+    BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
     comm_interface.rx_active = false;  // Not really active now...
     TimerStop(&comm_interface.byte_timer);
     comm_interface.byte_timeout = false;
   } else {
     comm_interface.state = COMM_INTERFACE_STATE_TYPE;
-    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_TYPE\r\n", __FUNCTION__);
+    BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_TYPE\r\n", __FUNCTION__);
     store_byte(input);
   }
 }
@@ -334,54 +751,64 @@ static void handle_type(uint8_t input)
   switch (input)
   {
     case REQUEST:
-      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X REQUEST\r\n", __FUNCTION__, input);
+      BINLOG_DEBUG("%s: rx_byte = 0x%02X REQUEST\r\n", __FUNCTION__, input);
       break;
     case RESPONSE:
-      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X RESPONSE\r\n", __FUNCTION__, input);
+      BINLOG_DEBUG("%s: rx_byte = 0x%02X RESPONSE\r\n", __FUNCTION__, input);
       break;
     default:
-      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X UNKNOWN\r\n", __FUNCTION__, input);
+      BINLOG_DEBUG("%s: rx_byte = 0x%02X UNKNOWN\r\n", __FUNCTION__, input);
       break;
   }
   if (input > RESPONSE) {
     comm_interface.state = COMM_INTERFACE_STATE_SOF; // Restart looking for SOF
-    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
+    BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
     comm_interface.rx_active = false;  // Not really active now...
     TimerStop(&comm_interface.byte_timer);
     comm_interface.byte_timeout = false;
   } else {
     comm_interface.state = COMM_INTERFACE_STATE_CMD;
-    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_CMD\r\n", __FUNCTION__);
+    BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_CMD\r\n", __FUNCTION__);
     store_byte(input);
   }
 }
 
 static void handle_cmd(uint8_t input)
 {
-  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
+  BINLOG_DEBUG("%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
   store_byte(input);
 
-  if (serial_frame->len > 3) {
-    comm_interface.rx_wait_count = serial_frame->len - 3;
+  if (rx_frame->len > 3) {
+    comm_interface.rx_wait_count = rx_frame->len - 3;
     comm_interface.state = COMM_INTERFACE_STATE_DATA;
-    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_DATA\r\n", __FUNCTION__);
+    BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_DATA\r\n", __FUNCTION__);
   } else {
     comm_interface.rx_wait_count = 1;
     comm_interface.state = COMM_INTERFACE_STATE_CHECKSUM;
-    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_CHECKSUM\r\n", __FUNCTION__);
+    BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_CHECKSUM\r\n", __FUNCTION__);
   }
 }
 
-static void handle_data(uint8_t input)
+static void handle_data(void)
 {
-  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
-  comm_interface.rx_wait_count--;
-  store_byte(input);
+  /* Copy as much of the frame body as this chunk holds in one go */
+  uint8_t count = rx_chunk_remaining();
+  if (count > comm_interface.rx_wait_count) {
+    count = comm_interface.rx_wait_count;
+  }
+  if (count > (RECEIVE_BUFFER_SIZE - comm_interface.buffer_len)) {
+    count = RECEIVE_BUFFER_SIZE - comm_interface.buffer_len;
+  }
+  memcpy(&comm_interface.buffer[comm_interface.buffer_len], &rx_chunk[comm_interface.rx_chunk_pos], count);
+  comm_interface.rx_chunk_pos += count;
+  comm_interface.buffer_len += count;
+  comm_interface.rx_wait_count -= count;
+  BINLOG_DEBUG("%s: %d bytes, %d left\r\n", __FUNCTION__, count, comm_interface.rx_wait_count);
 
   if ((comm_interface.buffer_len >= RECEIVE_BUFFER_SIZE)
-      || (comm_interface.buffer_len > serial_frame->len)) { //buffer_len - sizeof(sof) >= serial_frame->len
+      || (comm_interface.buffer_len > rx_frame->len)) { //buffer_len - sizeof(sof) >= rx_frame->len
     comm_interface.state = COMM_INTERFACE_STATE_CHECKSUM;
-    ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_CHECKSUM\r\n", __FUNCTION__);
+    BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_CHECKSUM\r\n", __FUNCTION__);
   }
 }
 
@@ -392,38 +819,57 @@ static comm_interface_parse_result_t handle_checksum(uint8_t input, bool ack)
   comm_interface.state = COMM_INTERFACE_STATE_SOF; // Restart looking for SOF
   comm_interface.rx_active = false;  // Not really active
 
-  /* Default values for ack == false */
-  /* It means we are in the process of looking for an acknowledge to a callback request */
+  /* ack == false means we are in the process of looking for an acknowledge to a callback request */
   // MAB 2025.10.22 - Another way to think of it:
-  // comm_interface.c, SerialAPIStateHandler() state is stateTxSerial, stateCallbackTxSerial or stateCommandTxSerial
-  /* Drop the new frame we received - we don't have time to handle it. */
+  // comm_interface.c, SerialAPIStateHandler() state is stateTxSerial, stateCallbackTxSerial or stateWindowTxSerial
+  /* The frame is then kept in rx_pending until the ACK has arrived. If rx_pending is full the frame
+     is dropped with CAN - we don't have time to handle it. */
   comm_interface_parse_result_t result = PARSE_IDLE;
   uint8_t response = CAN;
 
   /* Do we send ACK/NAK according to checksum... */
   /* if not then the received frame is dropped! */
-  if (ack) {
-    uint8_t checksum = xor_checksum(0xFF, &serial_frame->len, serial_frame->len);
-    result = (input == checksum) ? PARSE_FRAME_RECEIVED : PARSE_FRAME_ERROR;
+  if (ack || (rx_pending.count < COMM_INTERFACE_RX_PENDING)) {
+    uint8_t checksum = xor_checksum(0xFF, &rx_frame->len, rx_frame->len);
     response = (input == checksum) ? ACK : NAK;
+    if (ack) {
+      result = (input == checksum) ? PARSE_FRAME_RECEIVED : PARSE_FRAME_ERROR;
+      rx_frame_timestamp = cmd_latency_timestamp();
+    } else if (input == checksum) {
+      const uint8_t slot = (rx_pending.head + rx_pending.count) % COMM_INTERFACE_RX_PENDING;
+      memcpy(rx_pending.frame[slot], comm_interface.buffer, comm_interface.buffer_len);
+      rx_pending.timestamp[slot] = cmd_latency_timestamp();
+      rx_pending.count++;
+      BINLOG_DEBUG("%s: frame kept while waiting for ACK, %d pending\r\n", __FUNCTION__, rx_pending.count);
+    }
+    if ((input == checksum) && comm_interface.baud_rate_probing) {
+      /* The host is talking to us at the new rate, keep it */
+      comm_interface.baud_rate_probing = false;
+      TimerStop(&comm_interface.baud_rate_timer);
+      if (comm_interface.baud_rate_cb) {
+        comm_interface.baud_rate_cb(comm_interface.baud_rate);
+      }
+    }
   }
-  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
+  BINLOG_DEBUG("%s: rx_byte = 0x%02X\r\n", __FUNCTION__, input);
   switch (response)
   {
     case ACK:
-      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: response= ACK (checksum OK)\r\n", __FUNCTION__);
+      BINLOG_DEBUG("%s: response= ACK (checksum OK)\r\n", __FUNCTION__);
       break;
     case NAK:
-      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: response= NAK (checksum error)\r\n", __FUNCTION__);
+      stats.nak_sent++;
+      BINLOG_DEBUG("%s: response= NAK (checksum error)\r\n", __FUNCTION__);
       break;
     case CAN:
-      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: response= CAN (unable to process received frame: received frame dropped)\r\n", __FUNCTION__);
+      stats.can_sent++;
+      BINLOG_DEBUG("%s: response= CAN (unable to process received frame: received frame dropped)\r\n", __FUNCTION__);
       break;
     default:
       ZPAL_LOG_WARNING(ZPAL_LOG_APP, "%s: response= 0x%02X UNKNOWN\r\n", __FUNCTION__, response);
       break;
   }
-  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
+  BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
 
   ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Send ACK (checksum OK), NAK (checksum error) or CAN (unable to process received frame: received frame dropped)
@@ -436,30 +882,74 @@ static comm_interface_parse_result_t handle_checksum(uint8_t input, bool ack)
 static void handle_default(void)
 {
   comm_interface.state = COMM_INTERFACE_STATE_SOF; // Restart looking for SOF
-  ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
+  BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
   comm_interface.rx_active = false;  // Not really active now...
   comm_interface.ack_timeout = false;
   comm_interface.byte_timeout = false;
   TimerStop(&comm_interface.ack_timer);
-  TimerStop(&comm_interface.buffer_check_timer);
   TimerStop(&comm_interface.byte_timer);
 }
 
+/**
+ * Skip bytes in front of the next SOF when not waiting for an ACK. They
+ * cannot start a frame, so there is no need to feed them one by one to
+ * handle_sof().
+ */
+static void skip_to_sof(void)
+{
+  const uint8_t *start = &rx_chunk[comm_interface.rx_chunk_pos];
+  const uint8_t *sof = memchr(start, SOF, rx_chunk_remaining());
+  uint8_t skipped = (NULL == sof) ? rx_chunk_remaining() : (uint8_t)(sof - start);
+
+  if (skipped) {
+    BINLOG_DEBUG("%s: %d bytes dropped\r\n", __FUNCTION__, skipped);
+    comm_interface.rx_chunk_pos += skipped;
+    comm_interface.ack_timeout = false;
+    TimerStop(&comm_interface.ack_timer);
+  }
+}
+
+bool comm_interface_rx_pending(void)
+{
+  return (rx_pending.count > (rx_pending.delivered ? 1 : 0));
+}
+
+uint32_t comm_interface_frame_timestamp(void)
+{
+  return rx_pending.delivered ? rx_pending.timestamp[rx_pending.head] : rx_frame_timestamp;
+}
+
 comm_interface_parse_result_t comm_interface_parse_data(bool ack)
 {
   uint8_t rx_byte = 0;
   comm_interface_parse_result_t result = PARSE_IDLE;
 
-  while ((result == PARSE_IDLE) && zpal_uart_get_available(comm_interface.transport.handle)) {
-    zpal_uart_receive(comm_interface.transport.handle, &rx_byte, sizeof(rx_byte));
-//    if (isprint(rx_byte))
-//      {
-//        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X \t %c\r\n", __FUNCTION__, rx_byte, rx_byte);
-//      }
-//    else
-//      {
-//        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: rx_byte = 0x%02X\r\n", __FUNCTION__, rx_byte);
-//      }
+  /* The frame handed out last time has been handled by now */
+  if (rx_pending.delivered) {
+    rx_pending.delivered = false;
+    rx_pending.head = (rx_pending.head + 1) % COMM_INTERFACE_RX_PENDING;
+    rx_pending.count--;
+  }
+  serial_frame = rx_frame;
+  /* Frames kept while waiting for an ACK go first, they were received before anything in the UART */
+  if (ack && rx_pending.count) {
+    serial_frame = (comm_interface_frame_ptr)rx_pending.frame[rx_pending.head];
+    rx_pending.delivered = true;
+    return PARSE_FRAME_RECEIVED;
+  }
+
+  while ((result == PARSE_IDLE) && rx_chunk_fill()) {
+    if (COMM_INTERFACE_STATE_DATA == comm_interface.state) {
+      handle_data();
+      continue;
+    }
+    if ((COMM_INTERFACE_STATE_SOF == comm_interface.state) && !comm_interface.ack_needed) {
+      skip_to_sof();
+      if (!rx_chunk_remaining()) {
+        continue;
+      }
+    }
+    rx_byte = rx_chunk[comm_interface.rx_chunk_pos++];
 
     switch (comm_interface.state) {
       case COMM_INTERFACE_STATE_SOF:
@@ -478,14 +968,14 @@ comm_interface_parse_result_t comm_interface_parse_data(bool ack)
         handle_cmd(rx_byte);
         break;
 
-      case COMM_INTERFACE_STATE_DATA:
-        handle_data(rx_byte);
-        break;
-
       case COMM_INTERFACE_STATE_CHECKSUM:
         result = handle_checksum(rx_byte, ack);
         break;
 
+      case COMM_INTERFACE_STATE_ACK_SEQ:
+        result = handle_ack_seq(rx_byte);
+        break;
+
       default:
         handle_default();
         break;
@@ -497,9 +987,10 @@ comm_interface_parse_result_t comm_interface_parse_data(bool ack)
     /* Are we in the middle of collecting a frame and have we timed out? */
     if (comm_interface.rx_active && comm_interface.byte_timeout) {
       comm_interface.byte_timeout = false;
+      stats.byte_timeouts++;
       /* Reset to SOF hunting */
       comm_interface.state = COMM_INTERFACE_STATE_SOF;
-      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
+      BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
       comm_interface.rx_active = false; /* Not inframe anymore */
       result = PARSE_RX_TIMEOUT;
     }
@@ -507,9 +998,16 @@ comm_interface_parse_result_t comm_interface_parse_data(bool ack)
     /* Are we waiting for ACK and have we timed out? */
     if (comm_interface.ack_needed && comm_interface.ack_timeout) {
       comm_interface.ack_timeout = false;
+      stats.ack_timeouts++;
+      /* Back off until an ACK to a frame sent once gives a new round trip time */
+      comm_interface.rtt_frame = NULL;
+      comm_interface.ack_rto_ms *= 2;
+      if (comm_interface.ack_rto_ms > comm_interface.ack_timeout_ms) {
+        comm_interface.ack_rto_ms = comm_interface.ack_timeout_ms;
+      }
       /* Reset to SOF hunting */
       comm_interface.state = COMM_INTERFACE_STATE_SOF;
-      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
+      BINLOG_DEBUG("%s: comm_interface.state = COMM_INTERFACE_STATE_SOF\r\n", __FUNCTION__);
       /* Not waiting for ACK anymore */
       comm_interface.ack_needed = false;
       /* Tell upper layer we could not get the frame through */
@@ -543,6 +1041,10 @@ comm_interface_parse_result_t comm_interface_parse_data(bool ack)
       set_expect_bytes(CRC_LEN);
       break;
 
+    case COMM_INTERFACE_STATE_ACK_SEQ:
+      set_expect_bytes(ACK_LEN);
+      break;
+
     default:
       break;
   }
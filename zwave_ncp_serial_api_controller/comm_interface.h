@@ -21,6 +21,11 @@
 #define FRAME_LENGTH_MIN        3
 #define FRAME_LENGTH_MAX        RECEIVE_BUFFER_SIZE
 
+/* Windowed transmission: max frames in flight and sequence number coding in the frame type byte */
+#define TX_WINDOW_SIZE_MAX      4
+#define TX_WINDOW_SEQ_MASK      0x0F
+#define TX_WINDOW_SEQ_SHIFT     4
+
 typedef enum {
   TRANSPORT_TYPE_UART,
   TRANSPORT_TYPE_SPI,
@@ -33,13 +38,16 @@ typedef enum {
   PARSE_FRAME_SENT,       // returned if frame was ACKed by the other end
   PARSE_FRAME_ERROR,      // returned if frame has error in Checksum
   PARSE_RX_TIMEOUT,       // returned if Rx timeout has happened
-  PARSE_TX_TIMEOUT        // returned if Tx timeout (waiting for ACK) ahs happened
+  PARSE_TX_TIMEOUT,       // returned if Tx timeout (waiting for ACK) ahs happened
+  PARSE_TX_NAK            // returned if the frame was NAKed, retransmit at once
 } comm_interface_parse_result_t;
 
 typedef void * transport_handle_t;
 
 typedef void (*transmit_done_cb_t)(transport_handle_t transport);
 
+typedef void (*baud_rate_confirmed_cb_t)(uint32_t baud_rate);
+
 typedef struct _transport_t{
   transport_type_t type;
   transport_handle_t handle;
@@ -53,7 +61,35 @@ typedef struct {
   uint8_t payload[RECEIVE_BUFFER_SIZE]; //size defined to fix SonarQube errors
 } *comm_interface_frame_ptr;
 
-extern comm_interface_frame_ptr const serial_frame;
+/* Frame of the last PARSE_FRAME_RECEIVED, valid until comm_interface_parse_data() is called again */
+extern comm_interface_frame_ptr serial_frame;
+
+/* Layout of a frame on the wire: SOF | len | type | cmd | payload[len - 3] | checksum */
+#define FRAME_SOF_IDX           0
+#define FRAME_LEN_IDX           1
+#define FRAME_TYPE_IDX          2
+#define FRAME_CMD_IDX           3
+#define FRAME_HEADER_LEN        4
+#define FRAME_CHECKSUM_LEN      1
+
+/** Size of a buffer holding a complete frame with @p payload_len bytes of payload */
+#define FRAME_BUFFER_SIZE(payload_len) (FRAME_HEADER_LEN + (payload_len) + FRAME_CHECKSUM_LEN)
+/** Where the payload of a frame built with comm_interface_frame_build() goes */
+#define FRAME_PAYLOAD(frame)           (&(frame)[FRAME_HEADER_LEN])
+/** Number of bytes to put on the wire for a built frame */
+#define FRAME_TOTAL_LEN(frame)         ((frame)[FRAME_LEN_IDX] + 2)
+
+/* Serial link events, counted since start up or the last comm_interface_stats_reset() */
+typedef struct {
+  uint32_t nak_sent;        ///< Received frames with a checksum error
+  uint32_t can_sent;        ///< Received frames dropped while waiting for an ACK
+  uint32_t byte_timeouts;   ///< Received frames abandoned on the inter-byte timeout
+  uint32_t nak_received;    ///< Transmitted frames rejected by the host
+  uint32_t can_received;    ///< Transmitted frames dropped by the host
+  uint32_t ack_timeouts;    ///< Transmitted frames not acknowledged in time
+  uint32_t retransmits;     ///< Retransmissions, including go back N of a whole window
+  uint32_t rx_overruns;     ///< Times the RX ring was found full, bytes were lost
+} comm_interface_stats_t;
 
 static inline uint8_t frame_payload_len(const comm_interface_frame_ptr frame)
 {
@@ -61,14 +97,168 @@ static inline uint8_t frame_payload_len(const comm_interface_frame_ptr frame)
 }
 
 void comm_interface_transmit_frame(uint8_t cmd, uint8_t type, const uint8_t *payload, uint8_t len, transmit_done_cb_t cb);
+
+/**
+ * Fill in SOF, length, type, command and checksum around a payload already placed at
+ * FRAME_PAYLOAD(frame).
+ *
+ * @param frame Buffer of at least FRAME_BUFFER_SIZE(len) bytes.
+ * @param cmd Function ID
+ * @param type REQUEST or RESPONSE
+ * @param len Payload length
+ * @return Number of bytes in the frame.
+ */
+uint8_t comm_interface_frame_build(uint8_t *frame, uint8_t cmd, uint8_t type, uint8_t len);
+
+/**
+ * Transmit a frame built with comm_interface_frame_build() without copying it.
+ *
+ * Retransmissions (comm_interface_transmit_frame() with a NULL payload) are sent from @p frame as
+ * well, so it must stay untouched until the frame has been acknowledged or given up.
+ *
+ * @param frame Complete frame
+ * @param cb Invoked when the frame has been handed to the UART
+ */
+void comm_interface_transmit_framed(const uint8_t *frame, transmit_done_cb_t cb);
 void comm_interface_wait_transmit_done(void);
-void comm_interface_init(void);
+void comm_interface_init(uint32_t baud_rate);
 uint32_t comm_interface_get_ack_timeout_ms(void);
 void comm_interface_set_ack_timeout_ms(uint32_t t);
+
+/**
+ * The ACK timeout of windowed frames adapts to the measured host round trip time. It stays between
+ * ACK_TIMEOUT_MIN_MS and the timeout set with comm_interface_set_ack_timeout_ms(), and is doubled
+ * on every timeout until a new round trip time has been measured. Frames of the legacy protocol
+ * carry no sequence number, so the host cannot detect a duplicate, and always wait for the timeout
+ * set with comm_interface_set_ack_timeout_ms().
+ *
+ * @return The ACK timeout in use, in ms.
+ */
+uint32_t comm_interface_get_ack_rto_ms(void);
+/**
+ * @return Serial link event counters.
+ */
+const comm_interface_stats_t *comm_interface_stats(void);
+
+/**
+ * Clear the serial link event counters.
+ */
+void comm_interface_stats_reset(void);
+
 uint32_t comm_interface_get_byte_timeout_ms(void);
 void comm_interface_set_byte_timeout_ms(uint32_t t);
+
+/**
+ * Parse received data.
+ *
+ * @param ack true to acknowledge and return received frames. false while waiting for an ACK: up to
+ *            COMM_INTERFACE_RX_PENDING host frames are then acknowledged and kept, and returned by
+ *            the next calls with @p ack true before anything else. Frames beyond that get CAN.
+ * @return PARSE_FRAME_RECEIVED with the frame in serial_frame, or another parse event.
+ */
 comm_interface_parse_result_t comm_interface_parse_data(bool ack);
 
+/**
+ * @return true if host frames kept while waiting for an ACK are waiting to be returned by
+ *         comm_interface_parse_data().
+ */
+bool comm_interface_rx_pending(void);
+
+/**
+ * @return cmd_latency_timestamp() taken when the frame in serial_frame passed its checksum, also
+ *         for a frame kept while waiting for an ACK.
+ */
+uint32_t comm_interface_frame_timestamp(void);
+
+/**
+ * Request a new UART baud rate.
+ *
+ * The rate is switched when the host acknowledges the frame transmitted next (the RESPONSE to the
+ * request). If no frame with a valid checksum is received at the new rate within the fallback
+ * timeout, the previous rate is restored. Otherwise @p cb is invoked so the rate can be persisted.
+ *
+ * @param baud_rate One of the rates returned by comm_interface_get_supported_baud_rates().
+ * @param cb Invoked once the host has been heard at the new rate. Can be NULL.
+ * @return true if the baud rate is supported and the switch has been scheduled.
+ */
+bool comm_interface_set_baud_rate(uint32_t baud_rate, baud_rate_confirmed_cb_t cb);
+
+/**
+ * @return The UART baud rate in use.
+ */
+uint32_t comm_interface_get_baud_rate(void);
+
+/**
+ * @param[out] rates Set to point to the table of supported baud rates.
+ * @return Number of entries in @p rates.
+ */
+uint8_t comm_interface_get_supported_baud_rates(const uint32_t **rates);
+
+/**
+ * Set the number of REQUEST frames allowed in flight.
+ *
+ * 0 selects the legacy protocol (one frame, plain ACK). 1..TX_WINDOW_SIZE_MAX selects windowed
+ * transmission where REQUEST frames carry a sequence number in the upper nibble of the type byte
+ * and the host acknowledges with ACK followed by the sequence number of the newest frame received
+ * in order (cumulative ACK). Can only be changed while no windowed frames are in flight.
+ *
+ * @param size Requested window size. Values above TX_WINDOW_SIZE_MAX are clamped.
+ * @return true if the window size was changed, false if frames are still in flight.
+ */
+bool comm_interface_set_tx_window(uint8_t size);
+
+/**
+ * @return Negotiated window size, 0 when the legacy protocol is used.
+ */
+uint8_t comm_interface_get_tx_window(void);
+
+/**
+ * @return true if no more frames may be transmitted until an ACK arrives.
+ */
+bool comm_interface_tx_window_full(void);
+
+/**
+ * @return Number of windowed frames transmitted and not yet acknowledged.
+ */
+uint8_t comm_interface_tx_window_outstanding(void);
+
+/**
+ * Transmit a REQUEST frame in windowed mode.
+ *
+ * The sequence number is written into the type byte of @p frame and the checksum is updated in
+ * place. The frame is not copied and must stay valid until it is returned by
+ * comm_interface_tx_window_pop_acked().
+ *
+ * @param frame Frame built with comm_interface_frame_build()
+ * @param tag Caller context returned with the frame when it has been acknowledged
+ */
+void comm_interface_transmit_window_frame(uint8_t *frame, uint8_t tag);
+
+/**
+ * Remove the oldest acknowledged (or aborted) windowed frame.
+ *
+ * @param[out] tag Tag given when the frame was transmitted
+ * @return true if a frame was removed, false if no acknowledged frames are pending.
+ */
+bool comm_interface_tx_window_pop_acked(uint8_t *tag);
+
+/**
+ * Give up on all windowed frames in flight. They are returned by comm_interface_tx_window_pop_acked().
+ */
+void comm_interface_tx_window_abort(void);
+
+/**
+ * Board hook driving the RTS line from the RX ring level.
+ *
+ * The UART driver only gets the CTS pin through SerialAPI_get_uart_config_ext(). Its own RTS would
+ * follow the hardware FIFO rather than the RX ring, so RTS is driven as a GPIO here instead. The
+ * default drives SERIAL_API_RTS_PORT/PIN of serial_api_config.h, active low, and does nothing when
+ * no RTS pin is configured. Called from the UART receive interrupt and from the application task.
+ *
+ * @param ready true to let the host send, false to make it stop.
+ */
+void SerialAPI_set_rts(bool ready);
+
 /**
  * @}
  * @}
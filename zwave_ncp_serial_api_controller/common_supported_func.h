@@ -59,3 +59,6 @@
 
 #define SUPPORT_SERIAL_API_SOFT_RESET                   1
 #define SUPPORT_SERIAL_API_SETUP                        1
+#define SUPPORT_SERIAL_API_BATCH                        1
+#define SUPPORT_SERIAL_API_LINK_STATS                   1
+#define SUPPORT_SERIAL_API_LATENCY                      1
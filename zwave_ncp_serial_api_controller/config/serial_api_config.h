@@ -10,7 +10,7 @@
 
 // <<< sl:start pin_tool >>>
 
-// <usart signal=TX,RX> SERIAL_API
+// <usart signal=TX,RX,(CTS),(RTS)> SERIAL_API
 
 // $[USART_SERIAL_API]
 #ifndef SERIAL_API_PERIPHERAL                   
@@ -0,0 +1,22 @@
+/**
+ * @file
+ * CRC-32 (IEEE 802.3, as used by zlib).
+ *
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#ifndef _CRC32_H_
+#define _CRC32_H_
+
+#include <stdint.h>
+
+/**
+ * Continue a CRC-32 over more data.
+ *
+ * @param crc CRC of the data so far, 0 to start
+ * @param pData Data
+ * @param length Number of bytes in @p pData
+ * @return CRC of all data so far
+ */
+uint32_t crc32_update(uint32_t crc, const uint8_t *pData, uint32_t length);
+
+#endif /* _CRC32_H_ */
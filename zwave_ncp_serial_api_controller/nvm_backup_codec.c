@@ -0,0 +1,159 @@
+/**
+ * @file
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#include <string.h>
+#include "nvm_backup_codec.h"
+
+#define LITERAL_MAX       128
+#define ERASED_MAX        16384
+#define COPY_MIN          4
+#define COPY_MAX          (COPY_MIN + 63)
+#define COPY_SIZE         3
+
+#define TOKEN_ERASED      0x80
+#define TOKEN_COPY        0xC0
+
+#define MATCH_TABLE_BITS  8
+#define MATCH_NONE        0xFFFF
+
+/* Last position of each hashed 4 byte string in the block being encoded */
+static uint16_t match_table[1 << MATCH_TABLE_BITS];
+
+static uint8_t match_hash(const uint8_t *p)
+{
+  uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  v *= 2654435761u;
+  /* Fold in the lower bits too, strings of consecutive byte values differ little in the top ones */
+  return (uint8_t)((v >> (32 - MATCH_TABLE_BITS)) ^ (v >> (32 - (2 * MATCH_TABLE_BITS))));
+}
+
+/* Bytes taken by pending literals once written */
+static uint8_t literal_size(uint16_t pending)
+{
+  return pending ? (uint8_t)(pending + 1) : 0;
+}
+
+static uint8_t literal_flush(const uint8_t *pRaw, uint16_t start, uint16_t pending, uint8_t *pOut)
+{
+  if (0 == pending) {
+    return 0;
+  }
+  pOut[0] = (uint8_t)(pending - 1);
+  memcpy(&pOut[1], &pRaw[start], pending);
+  return (uint8_t)(pending + 1);
+}
+
+uint16_t nvm_backup_encode(const uint8_t *pRaw, uint16_t rawLength, uint8_t *pOut, uint8_t outSize, uint8_t *pOutLength)
+{
+  uint16_t pos = 0;
+  uint16_t literalStart = 0;
+  uint8_t o = 0;
+
+  memset(match_table, 0xFF, sizeof(match_table));
+
+  while (pos < rawLength) {
+    const uint16_t pending = pos - literalStart;
+    uint8_t token[COPY_SIZE];
+    uint8_t tokenSize = 0;
+    uint16_t length = 0;
+
+    if (NVM_BACKUP_CODEC_ERASED == pRaw[pos]) {
+      while (((pos + length) < rawLength) && (length < ERASED_MAX)
+             && (NVM_BACKUP_CODEC_ERASED == pRaw[pos + length])) {
+        length++;
+      }
+      if (length >= 3) {
+        token[0] = (uint8_t)(TOKEN_ERASED | ((length - 1) >> 8));
+        token[1] = (uint8_t)(length - 1);
+        tokenSize = 2;
+      }
+    }
+    if ((0 == tokenSize) && ((pos + COPY_MIN) <= rawLength)) {
+      const uint8_t hash = match_hash(&pRaw[pos]);
+      const uint16_t candidate = match_table[hash];
+      match_table[hash] = pos;
+      if ((MATCH_NONE != candidate) && (0 == memcmp(&pRaw[candidate], &pRaw[pos], COPY_MIN))) {
+        length = COPY_MIN;
+        while (((pos + length) < rawLength) && (length < COPY_MAX)
+               && (pRaw[candidate + length] == pRaw[pos + length])) {
+          length++;
+        }
+        const uint16_t distance = pos - candidate;
+        token[0] = (uint8_t)(TOKEN_COPY | (length - COPY_MIN));
+        token[1] = (uint8_t)(distance >> 8);
+        token[2] = (uint8_t)distance;
+        tokenSize = COPY_SIZE;
+      }
+    }
+
+    if (tokenSize) {
+      if ((o + literal_size(pending) + tokenSize) > outSize) {
+        break;
+      }
+      o += literal_flush(pRaw, literalStart, pending, &pOut[o]);
+      memcpy(&pOut[o], token, tokenSize);
+      o += tokenSize;
+      pos += length;
+      literalStart = pos;
+    } else {
+      if ((o + literal_size(pending + 1)) > outSize) {
+        break;
+      }
+      pos++;
+      if (LITERAL_MAX == (pos - literalStart)) {
+        o += literal_flush(pRaw, literalStart, LITERAL_MAX, &pOut[o]);
+        literalStart = pos;
+      }
+    }
+  }
+  o += literal_flush(pRaw, literalStart, pos - literalStart, &pOut[o]);
+  *pOutLength = o;
+  return pos;
+}
+
+bool nvm_backup_decode(const uint8_t *pIn, uint8_t inLength, uint8_t *pRaw, uint16_t rawSize, uint16_t *pRawLength)
+{
+  uint8_t i = 0;
+  uint16_t o = 0;
+
+  while (i < inLength) {
+    const uint8_t token = pIn[i++];
+    uint16_t length;
+
+    if (0 == (token & TOKEN_ERASED)) {
+      length = (uint16_t)token + 1;
+      if (((i + length) > inLength) || ((o + length) > rawSize)) {
+        return false;
+      }
+      memcpy(&pRaw[o], &pIn[i], length);
+      i = (uint8_t)(i + length);
+    } else if (TOKEN_ERASED == (token & TOKEN_COPY)) {
+      if (i >= inLength) {
+        return false;
+      }
+      length = (uint16_t)((((uint16_t)(token & 0x3F) << 8) | pIn[i++]) + 1);
+      if ((o + length) > rawSize) {
+        return false;
+      }
+      memset(&pRaw[o], NVM_BACKUP_CODEC_ERASED, length);
+    } else {
+      if ((i + 2) > inLength) {
+        return false;
+      }
+      const uint16_t distance = (uint16_t)((pIn[i] << 8) | pIn[i + 1]);
+      i += 2;
+      length = (uint16_t)((token & 0x3F) + COPY_MIN);
+      if ((0 == distance) || (distance > o) || ((o + length) > rawSize)) {
+        return false;
+      }
+      /* Byte by byte, the copy may overlap the bytes it produces */
+      for (uint16_t n = 0; n < length; n++) {
+        pRaw[o + n] = pRaw[o + n - distance];
+      }
+    }
+    o += length;
+  }
+  *pRawLength = o;
+  return true;
+}
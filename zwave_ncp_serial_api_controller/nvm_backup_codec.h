@@ -0,0 +1,51 @@
+/**
+ * @file
+ * Compression of NVM backup images.
+ *
+ * NVM3 areas are mostly erased flash and repeated object headers. The codec encodes runs of
+ * erased (0xFF) bytes in two bytes and repeated strings as references to earlier data in the same
+ * block. Each block is encoded on its own, so blocks can be decoded in any order.
+ *
+ * A block is a sequence of tokens:
+ *   0LLLLLLL                    L + 1 literal bytes follow (1 to 128)
+ *   10LLLLLL LLLLLLLL           L + 1 erased bytes (1 to 16384)
+ *   11LLLLLL DDDDDDDD DDDDDDDD  copy L + 4 bytes (4 to 67) starting D bytes back (MSB first)
+ * A copy may overlap the bytes it produces, so it also encodes runs of any other value.
+ *
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#ifndef _NVM_BACKUP_CODEC_H_
+#define _NVM_BACKUP_CODEC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NVM_BACKUP_CODEC_ERASED    0xFF
+
+/**
+ * Encode as much of a block as fits in the output buffer.
+ *
+ * Not reentrant, the match table is static.
+ *
+ * @param pRaw Data to encode
+ * @param rawLength Number of bytes in @p pRaw
+ * @param pOut Encoded data
+ * @param outSize Size of @p pOut
+ * @param pOutLength Number of bytes written to @p pOut
+ * @return Number of bytes of @p pRaw encoded in @p pOut, from the start of @p pRaw.
+ */
+uint16_t nvm_backup_encode(const uint8_t *pRaw, uint16_t rawLength, uint8_t *pOut, uint8_t outSize, uint8_t *pOutLength);
+
+/**
+ * Decode a block.
+ *
+ * @param pIn Encoded data
+ * @param inLength Number of bytes in @p pIn
+ * @param pRaw Decoded data
+ * @param rawSize Size of @p pRaw
+ * @param pRawLength Number of bytes written to @p pRaw
+ * @return false if the block is malformed or does not fit in @p pRaw.
+ */
+bool nvm_backup_decode(const uint8_t *pIn, uint8_t inLength, uint8_t *pRaw, uint16_t rawSize, uint16_t *pRawLength);
+
+#endif /* _NVM_BACKUP_CODEC_H_ */
@@ -10,7 +10,12 @@
 #include <ZW_controller_api.h>
 #include <serialapi_file.h>
 #include <zpal_nvm.h>
+#include <AppTimer.h>
+#include <SwTimer.h>
 #include "zpal_log.h"
+#include "tx_scheduler.h"
+#include "nvm_backup_codec.h"
+#include "crc32.h"
 
 /*WARNING: The backup/restore feature is based on the thesis that the NVM area is one continuous block even if it consist of two blocks,
    A protocol and an application block. These blocks are defined in the linker script. The blocks are addressed using the data structure below.
@@ -33,6 +38,108 @@
    buffer[]           buffer only returned for operation=read
  */
 
+/* Stream operations, FUNC_ID_NVM_EXT_BACKUP_RESTORE only. Read the whole NVM without a request per chunk.
+   HOST->ZW:
+   operation          [stream=4|compressed stream=5]
+   credits            number of data frames the host can take from offset on, 0 stops the stream
+   offset(MSB)        first byte not received yet
+   ...
+   offset(LSB)
+
+   ZW->HOST (response):
+   retVal             [OK=0|error=1]
+   length             0
+   offset(MSB)        next byte the stream will send
+   ...
+   offset(LSB)
+
+   ZW->HOST (unsolicited REQUEST FUNC_ID_NVM_EXT_BACKUP_RESTORE, one per chunk):
+   operation          [stream=4|compressed stream=5]
+   retVal             [OK=0|error=1|EOF=-1]
+   length             length of buffer
+   offset(MSB)        pointer to NVM memory of the first data byte
+   ...
+   offset(LSB)
+   crc32(MSB)         CRC-32 of all NVM data from the start of the stream to the end of this frame
+   ...
+   crc32(LSB)
+   rawLength(MSB)     number of NVM bytes in buffer, only sent for operation=compressed stream
+   rawLength(LSB)
+   buffer[]           NVM data, one block encoded as described in nvm_backup_codec.h for operation=compressed stream
+
+   The first stream request after open, or after a stream was stopped, starts the stream at offset.
+   Later requests keep it going: the host sends its next expected offset and the number of frames it
+   can take from there, at most NVMBACKUP_STREAM_MAX_CREDITS, like a sliding window. The stream ends
+   with the EOF frame. To get lost frames again, the host stops the stream and starts it at the first
+   missing offset.
+ */
+/* Compressed write operation, FUNC_ID_NVM_EXT_BACKUP_RESTORE only.
+   HOST->ZW:
+   operation          compressed write=6
+   length             length of buffer
+   offset(MSB)        pointer to NVM memory
+   ...
+   offset(LSB)
+   buffer[]           one block encoded as described in nvm_backup_codec.h, at most NVMBACKUP_BLOCK_SIZE bytes decoded
+
+   ZW->HOST:
+   retVal             [OK=0|error=1|EOF=-1]
+   length             0
+   offset(MSB)        pointer to NVM memory after the written data, the offset of the next write
+   ...
+   offset(LSB)
+ */
+/* Digest operation, FUNC_ID_NVM_EXT_BACKUP_RESTORE only. Lets the host fetch or restore only the pages that changed.
+   HOST->ZW:
+   operation          digest=7
+   pageShift          page size as power of 2, NVMBACKUP_DIGEST_PAGE_SHIFT_MIN to NVMBACKUP_DIGEST_PAGE_SHIFT_MAX
+   offset(MSB)        pointer to NVM memory of the first page, rounded down to a page boundary
+   ...
+   offset(LSB)
+
+   ZW->HOST:
+   retVal             [OK=0|error=1|EOF=-1]
+   length             length of buffer, 4 bytes per page
+   offset(MSB)        pointer to NVM memory of the first page
+   ...
+   offset(LSB)
+   buffer[]           CRC-32 of each page (MSB first), the last page ends at the end of the NVM area
+
+   A response holds as many pages as fit in the frame and in NVMBACKUP_DIGEST_READ_MAX bytes of NVM,
+   but at least one. EOF is returned with the last page.
+ */
+#define NVMBACKUP_STREAM_CRC_SIZE         (4)
+#define NVMBACKUP_STREAM_RAW_LEN_SIZE     (2)
+#define NVMBACKUP_STREAM_HEADER_SIZE(compressed) \
+  (3 + NVM_EXT_BACKUP_RESTORE_ADDR_SIZE + NVMBACKUP_STREAM_CRC_SIZE + ((compressed) ? NVMBACKUP_STREAM_RAW_LEN_SIZE : 0))
+#define NVMBACKUP_STREAM_CHUNK_SIZE       (BUF_SIZE_TX - NVMBACKUP_STREAM_HEADER_SIZE(false))
+
+/* Period of the stream sending chunks while the host window and the transmit queue have room */
+#if !defined(NVMBACKUP_STREAM_PERIOD_MS)
+#define NVMBACKUP_STREAM_PERIOD_MS        5
+#endif
+
+/* Most frames the host can let the stream have on their way, must be a power of 2 */
+#if !defined(NVMBACKUP_STREAM_MAX_CREDITS)
+#define NVMBACKUP_STREAM_MAX_CREDITS      16
+#endif
+
+/* Most NVM bytes encoded in one compressed stream frame or decoded from one compressed write */
+#if !defined(NVMBACKUP_BLOCK_SIZE)
+#define NVMBACKUP_BLOCK_SIZE              1024
+#endif
+
+#define NVMBACKUP_DIGEST_PAGE_SHIFT_MIN   (8)
+#define NVMBACKUP_DIGEST_PAGE_SHIFT_MAX   (15)
+
+/* Most NVM bytes read for one digest request, keeps the response in time for the host */
+#if !defined(NVMBACKUP_DIGEST_READ_MAX)
+#define NVMBACKUP_DIGEST_READ_MAX         16384
+#endif
+
+_Static_assert((NVMBACKUP_STREAM_MAX_CREDITS & (NVMBACKUP_STREAM_MAX_CREDITS - 1)) == 0, "STATIC_ASSERT_NVMBACKUP_STREAM_MAX_CREDITS_not_power_of_2");
+_Static_assert(NVMBACKUP_BLOCK_SIZE <= UINT16_MAX, "STATIC_ASSERT_NVMBACKUP_BLOCK_SIZE_to_big");
+
 /* Macro and definitions used to get index of the different fields in NVM backup & restore buffer. */
 #define NVMBACKUP_RX_SUB_CMD_IDX          (0)   /** index of sub command field in rx buffer. */
 #define NVMBACKUP_RX_DATA_LEN_IDX         (1)   /** index of data length field in rx buffer. */
@@ -53,6 +160,24 @@
 
 static eNVMBackupRestoreOperation NVMBackupRestoreOperationInProgress = NVMBackupRestoreOperationClose;
 
+static struct {
+  bool active;
+  bool compressed;
+  bool timerRegistered;
+  uint32_t position;    /* next byte to send */
+  uint32_t frames;      /* frames sent since the stream started */
+  uint32_t windowEnd;   /* value of frames the host window ends at */
+  uint32_t frameOffset[NVMBACKUP_STREAM_MAX_CREDITS]; /* first byte of the last frames sent, by frame number */
+  uint32_t crc;
+  SSwTimer timer;
+  uint8_t frame[BUF_SIZE_TX];
+} nvmStream;
+
+/* NVM data of the compressed operations, nvmBlockLength bytes from nvmBlockOffset on */
+static uint8_t nvmBlock[NVMBACKUP_BLOCK_SIZE];
+static uint32_t nvmBlockOffset;
+static uint16_t nvmBlockLength;
+
 /**
  * This function is used to extract the address from a received frame (on serial API).
  * This address is extracted depending on the size of the address field (which depend on the command type:
@@ -106,6 +231,8 @@ static void NvmBackupAddrSet(uint8_t* pAddr, const nvm_backup_restore_addr_size_
  */
 static bool NvmBackupOpen(void)
 {
+  /* The backup must include application data changes not written yet */
+  SerialApiNvmFlushAppData();
   SZwaveCommandPackage nvmOpen = {
     .eCommandType = EZWAVECOMMANDTYPE_NVM_BACKUP_OPEN,
     .uCommandParams.NvmBackupRestore.offset = 0,
@@ -200,6 +327,251 @@ static uint8_t NvmBackupRestore(uint32_t offset, uint8_t length, uint8_t* pNvmDa
   return false;
 }
 
+/**
+ * Read NVM data into nvmBlock, starting at offset. Data already in nvmBlock is not read again.
+ *
+ * @param offset[in] The offset of the NVM area to read from
+ * @param nvm_storage_size[in] Size of the NVM area
+ *
+ * @return true if nvmBlock is full or holds the NVM area up to its end
+ */
+static bool NvmBackupBlockFill(uint32_t offset, uint32_t nvm_storage_size)
+{
+  if ((offset >= nvmBlockOffset) && (offset < (nvmBlockOffset + nvmBlockLength))) {
+    const uint16_t keep = (uint16_t)(nvmBlockOffset + nvmBlockLength - offset);
+    memmove(nvmBlock, &nvmBlock[offset - nvmBlockOffset], keep);
+    nvmBlockLength = keep;
+  } else {
+    nvmBlockLength = 0;
+  }
+  nvmBlockOffset = offset;
+
+  while ((nvmBlockLength < NVMBACKUP_BLOCK_SIZE) && ((offset + nvmBlockLength) < nvm_storage_size)) {
+    uint32_t length = nvm_storage_size - (offset + nvmBlockLength);
+    if (length > (uint32_t)(NVMBACKUP_BLOCK_SIZE - nvmBlockLength)) {
+      length = (uint32_t)(NVMBACKUP_BLOCK_SIZE - nvmBlockLength);
+    }
+    if (length > NVMBACKUP_STREAM_CHUNK_SIZE) {
+      length = NVMBACKUP_STREAM_CHUNK_SIZE;
+    }
+    if (!NvmBackupRead(offset + nvmBlockLength, (uint8_t)length, &nvmBlock[nvmBlockLength])) {
+      nvmBlockLength = 0;
+      return false;
+    }
+    nvmBlockLength = (uint16_t)(nvmBlockLength + length);
+  }
+  return true;
+}
+
+/**
+ * Decode a compressed write and write it to the NVM area
+ *
+ * @param offset[in] The offset of the NVM area to write to
+ * @param pIn[in] The encoded block
+ * @param inLength[in] Length of the encoded block
+ * @param nvm_storage_size[in] Size of the NVM area
+ * @param pWritten[out] Number of bytes written
+ *
+ * @return true if all decoded data is written else false
+ */
+static bool NvmBackupWriteBlock(uint32_t offset, const uint8_t *pIn, uint8_t inLength,
+                                uint32_t nvm_storage_size, uint16_t *pWritten)
+{
+  uint16_t rawLength = 0;
+
+  /* nvmBlock no longer holds NVM content after this */
+  nvmBlockLength = 0;
+  *pWritten = 0;
+  if (!nvm_backup_decode(pIn, inLength, nvmBlock, NVMBACKUP_BLOCK_SIZE, &rawLength)
+      || ((offset + rawLength) > nvm_storage_size)) {
+    ZPAL_LOG_ERROR(ZPAL_LOG_APP, "NVM_Write_decode_err \r\n");
+    return false;
+  }
+  while (*pWritten < rawLength) {
+    uint16_t length = rawLength - *pWritten;
+    if (length > NVMBACKUP_STREAM_CHUNK_SIZE) {
+      length = NVMBACKUP_STREAM_CHUNK_SIZE;
+    }
+    if (!NvmBackupRestore(offset + *pWritten, (uint8_t)length, &nvmBlock[*pWritten])) {
+      return false;
+    }
+    *pWritten = (uint16_t)(*pWritten + length);
+  }
+  return true;
+}
+
+/**
+ * Calculate the CRC-32 of consecutive NVM pages
+ *
+ * @param offset[in] The offset of the first page, a multiple of the page size
+ * @param pageShift[in] Page size as power of 2
+ * @param nvm_storage_size[in] Size of the NVM area
+ * @param pDigest[out] CRC-32 of each page, MSB first
+ * @param digestSize[in] Size of pDigest
+ * @param pPages[out] Number of pages in pDigest
+ *
+ * @return false if the NVM area cannot be read
+ */
+static bool NvmBackupDigest(uint32_t offset, uint8_t pageShift, uint32_t nvm_storage_size,
+                            uint8_t *pDigest, uint8_t digestSize, uint8_t *pPages)
+{
+  const uint32_t pageSize = (uint32_t)1 << pageShift;
+  uint32_t read = 0;
+
+  *pPages = 0;
+  while ((offset < nvm_storage_size) && ((*pPages + 1) * NVMBACKUP_STREAM_CRC_SIZE <= digestSize)
+         && ((0 == *pPages) || ((read + pageSize) <= NVMBACKUP_DIGEST_READ_MAX))) {
+    const uint32_t pageEnd = ((nvm_storage_size - offset) > pageSize) ? (offset + pageSize) : nvm_storage_size;
+    uint32_t crc = 0;
+
+    while (offset < pageEnd) {
+      if (!NvmBackupBlockFill(offset, nvm_storage_size)) {
+        return false;
+      }
+      const uint32_t length = ((pageEnd - offset) < nvmBlockLength) ? (pageEnd - offset) : nvmBlockLength;
+      crc = crc32_update(crc, nvmBlock, length);
+      offset += length;
+      read += length;
+    }
+    NvmBackupAddrSet(&pDigest[*pPages * NVMBACKUP_STREAM_CRC_SIZE], (nvm_backup_restore_addr_size_t)NVMBACKUP_STREAM_CRC_SIZE, crc);
+    (*pPages)++;
+  }
+  return true;
+}
+
+static void NvmBackupStreamStop(void)
+{
+  nvmStream.active = false;
+  if (nvmStream.timerRegistered) {
+    TimerStop(&nvmStream.timer);
+  }
+}
+
+/**
+ * Send chunks until the host window is full, the transmit queue has no room or EOF is reached.
+ * Runs in the application task, like the request handler.
+ */
+static void ZCB_NvmBackupStreamTimeout(__attribute__((unused)) SSwTimer *pTimer)
+{
+  const uint32_t nvm_storage_size = zpal_nvm_backup_get_size();
+  const uint8_t headerSize = NVMBACKUP_STREAM_HEADER_SIZE(nvmStream.compressed);
+
+  while (nvmStream.active && ((int32_t)(nvmStream.windowEnd - nvmStream.frames) > 0)
+         && tx_scheduler_has_room(TX_CLASS_APP_COMMAND, BUF_SIZE_TX)) {
+    uint8_t *pFrame = nvmStream.frame;
+    uint8_t status = NVMBackupRestoreReturnValueOK;
+    uint8_t dataLength = 0;
+    uint16_t rawLength = 0;
+    uint32_t crc = nvmStream.crc;
+    uint8_t i = 0;
+
+    if (nvmStream.compressed) {
+      if (NvmBackupBlockFill(nvmStream.position, nvm_storage_size)) {
+        rawLength = nvm_backup_encode(nvmBlock, nvmBlockLength, &pFrame[headerSize],
+                                      (uint8_t)(BUF_SIZE_TX - headerSize), &dataLength);
+        crc = crc32_update(crc, nvmBlock, rawLength);
+      } else {
+        status = NVMBackupRestoreReturnValueError;
+      }
+    } else {
+      dataLength = NVMBACKUP_STREAM_CHUNK_SIZE;
+      if ((nvm_storage_size - nvmStream.position) < dataLength) {
+        dataLength = (uint8_t)(nvm_storage_size - nvmStream.position);
+      }
+      if (NvmBackupRead(nvmStream.position, dataLength, &pFrame[headerSize])) {
+        rawLength = dataLength;
+        crc = crc32_update(crc, &pFrame[headerSize], dataLength);
+      } else {
+        status = NVMBackupRestoreReturnValueError;
+        dataLength = 0;
+      }
+    }
+    if ((NVMBackupRestoreReturnValueOK == status) && ((nvmStream.position + rawLength) >= nvm_storage_size)) {
+      status = (uint8_t)NVMBackupRestoreReturnValueEOF;
+    }
+
+    pFrame[i++] = nvmStream.compressed ? NVMBackupRestoreOperationStreamCompressed : NVMBackupRestoreOperationStream;
+    pFrame[i++] = status;
+    pFrame[i++] = dataLength;
+    NvmBackupAddrSet(&pFrame[i], NVM_EXT_BACKUP_RESTORE_ADDR_SIZE, nvmStream.position);
+    i += NVM_EXT_BACKUP_RESTORE_ADDR_SIZE;
+    NvmBackupAddrSet(&pFrame[i], (nvm_backup_restore_addr_size_t)NVMBACKUP_STREAM_CRC_SIZE, crc);
+    i += NVMBACKUP_STREAM_CRC_SIZE;
+    if (nvmStream.compressed) {
+      pFrame[i++] = (uint8_t)(rawLength >> 8);
+      pFrame[i++] = (uint8_t)rawLength;
+    }
+
+    if (!RequestUnsolicited(FUNC_ID_NVM_EXT_BACKUP_RESTORE, pFrame, (uint8_t)(i + dataLength))) {
+      /* A coalesced frame flushed first may have taken the slot. Nothing is advanced, the same
+         chunk is read and sent again on the next tick. */
+      break;
+    }
+    nvmStream.crc = crc;
+    nvmStream.frameOffset[nvmStream.frames & (NVMBACKUP_STREAM_MAX_CREDITS - 1)] = nvmStream.position;
+    nvmStream.frames++;
+    nvmStream.position += rawLength;
+    if (NVMBackupRestoreReturnValueOK != status) {
+      ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: NVM_Stream_end 0x%08x\r\n", __FUNCTION__, nvmStream.position);
+      nvmStream.active = false;
+    }
+  }
+  /* Wait for the host to open the window again */
+  if (!nvmStream.active || ((int32_t)(nvmStream.windowEnd - nvmStream.frames) <= 0)) {
+    TimerStop(&nvmStream.timer);
+  }
+}
+
+/**
+ * Start, continue or stop the stream.
+ *
+ * @param offset[in] First byte the host has not received yet
+ * @param credits[in] Number of frames the host can take from @p offset on
+ * @param compressed[in] Send the NVM data encoded
+ *
+ * @return false if the stream cannot run
+ */
+static bool NvmBackupStream(uint32_t offset, uint8_t credits, bool compressed)
+{
+  const uint32_t nvm_storage_size = zpal_nvm_backup_get_size();
+
+  if (0 == credits) {
+    NvmBackupStreamStop();
+    return true;
+  }
+  if (credits > NVMBACKUP_STREAM_MAX_CREDITS) {
+    credits = NVMBACKUP_STREAM_MAX_CREDITS;
+  }
+  if (!nvmStream.timerRegistered) {
+    nvmStream.timerRegistered = AppTimerRegister(&nvmStream.timer, true, ZCB_NvmBackupStreamTimeout);
+    if (!nvmStream.timerRegistered) {
+      return false;
+    }
+  }
+  if (offset >= nvm_storage_size) {
+    return false;
+  }
+  /* An offset ahead of the stream cannot acknowledge sent frames, the host wants to skip there */
+  if (!nvmStream.active || (compressed != nvmStream.compressed) || (offset > nvmStream.position)) {
+    nvmStream.active = true;
+    nvmStream.compressed = compressed;
+    nvmStream.position = offset;
+    nvmStream.frames = 0;
+    nvmStream.crc = 0;
+  }
+  /* Frames sent from offset on have not reached the host yet and count against its credits */
+  uint32_t acknowledged = nvmStream.frames;
+  while ((acknowledged > 0) && ((nvmStream.frames - acknowledged) < NVMBACKUP_STREAM_MAX_CREDITS)
+         && (nvmStream.frameOffset[(acknowledged - 1) & (NVMBACKUP_STREAM_MAX_CREDITS - 1)] >= offset)) {
+    acknowledged--;
+  }
+  nvmStream.windowEnd = acknowledged + credits;
+  if (((int32_t)(nvmStream.windowEnd - nvmStream.frames) > 0) && !TimerIsActive(&nvmStream.timer)) {
+    TimerStart(&nvmStream.timer, NVMBACKUP_STREAM_PERIOD_MS);
+  }
+  return true;
+}
+
 bool NvmBackupLegacyCmdAvailable(void)
 {
   /* If NVM size is 0x10000, the legacy command should be forbidden. However, for backward
@@ -212,7 +584,7 @@ bool NvmBackupLegacyCmdAvailable(void)
   }
 }
 
-void func_id_serial_api_nvm_backup_restore(__attribute__((unused)) uint8_t inputLength, uint8_t *pInputBuffer, uint8_t *pOutputBuffer, uint8_t *pOutputLength, bool extended)
+void func_id_serial_api_nvm_backup_restore(uint8_t inputLength, uint8_t *pInputBuffer, uint8_t *pOutputBuffer, uint8_t *pOutputLength, bool extended)
 {
   uint32_t NVM_WorkPtr = 0;
   uint8_t dataLength;
@@ -239,6 +611,8 @@ void func_id_serial_api_nvm_backup_restore(__attribute__((unused)) uint8_t input
         /* TODO */
         // here we have to  shut down RF and disable power management and close NVM subsystem
         if (NvmBackupOpen()) {
+          NvmBackupStreamStop();
+          nvmBlockLength = 0;
           NVMBackupRestoreOperationInProgress = NVMBackupRestoreOperationOpen;
           /* Set the size of the backup/restore. (Number of bytes in flash used for file systems) */
           /* Please note that the special case where nvm_storage_size == 0x10000 is indicated by 0x00 0x00 */
@@ -250,7 +624,11 @@ void func_id_serial_api_nvm_backup_restore(__attribute__((unused)) uint8_t input
               (1 << NVMBackupRestoreOperationOpen)
               + (1 << NVMBackupRestoreOperationRead)
               + (1 << NVMBackupRestoreOperationWrite)
-              + (1 << NVMBackupRestoreOperationClose);
+              + (1 << NVMBackupRestoreOperationClose)
+              + (1 << NVMBackupRestoreOperationStream)
+              + (1 << NVMBackupRestoreOperationStreamCompressed)
+              + (1 << NVMBackupRestoreOperationWriteCompressed)
+              + (1 << NVMBackupRestoreOperationDigest);
           }
           pOutputBuffer[NVMBACKUP_TX_DATA_LEN_IDX] = dataLength;
         } else {
@@ -317,6 +695,8 @@ void func_id_serial_api_nvm_backup_restore(__attribute__((unused)) uint8_t input
         }
         /* copy data into another buffer because write operation will be done in another task. */
         memcpy(tmp_buf, (uint8_t*)&pInputBuffer[NVMBACKUP_RX_DATA_IDX(addrSize)], dataLength);
+        /* The restored application data replaces the RAM copy */
+        SerialApiNvmDiscardAppData();
         NvmBackupRestore(NVM_WorkPtr, dataLength, tmp_buf);
         /* fill output buffer */
         pOutputBuffer[NVMBACKUP_TX_DATA_LEN_IDX] = dataLength;
@@ -327,8 +707,99 @@ void func_id_serial_api_nvm_backup_restore(__attribute__((unused)) uint8_t input
     }
     break;
 
+    case NVMBackupRestoreOperationStream: /* stream */
+    case NVMBackupRestoreOperationStreamCompressed: /* compressed stream */
+    {
+      if (false == extended) {
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueError;
+        break;
+      }
+      /* Check that NVM is ready */
+      if ((NVMBackupRestoreOperationInProgress != NVMBackupRestoreOperationRead)
+          && (NVMBackupRestoreOperationInProgress != NVMBackupRestoreOperationOpen)) {
+        ZPAL_LOG_WARNING(ZPAL_LOG_APP, "%s: NVM_Stream_Mis \r\n", __FUNCTION__);
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueOperationMismatch;
+        break;
+      }
+      NVMBackupRestoreOperationInProgress = NVMBackupRestoreOperationRead;
+      NVM_WorkPtr = NvmBackupAddrGet(&(pInputBuffer[NVMBACKUP_RX_ADDR_IDX]), addrSize);
+      if (!NvmBackupStream(NVM_WorkPtr, pInputBuffer[NVMBACKUP_RX_DATA_LEN_IDX],
+                           NVMBackupRestoreOperationStreamCompressed == pInputBuffer[NVMBACKUP_RX_SUB_CMD_IDX])) {
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueError;
+      }
+      NvmBackupAddrSet(&(pOutputBuffer[NVMBACKUP_TX_ADDR_IDX]), addrSize,
+                       nvmStream.active ? nvmStream.position : NVM_WorkPtr);
+    }
+    break;
+
+    case NVMBackupRestoreOperationWriteCompressed: /* compressed write */
+    {
+      uint16_t written = 0;
+      if (false == extended) {
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueError;
+        break;
+      }
+      /* Check that NVM is ready */
+      if ((NVMBackupRestoreOperationInProgress != NVMBackupRestoreOperationWrite)
+          && (NVMBackupRestoreOperationInProgress != NVMBackupRestoreOperationOpen)) {
+        ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: NVM_Write_mis \r\n", __FUNCTION__);
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueOperationMismatch;
+        break;
+      }
+      NVMBackupRestoreOperationInProgress = NVMBackupRestoreOperationWrite;
+      /* Load input */
+      dataLength = pInputBuffer[NVMBACKUP_RX_DATA_LEN_IDX];
+      NVM_WorkPtr = NvmBackupAddrGet(&(pInputBuffer[NVMBACKUP_RX_ADDR_IDX]), addrSize);
+      /* The restored application data replaces the RAM copy */
+      SerialApiNvmDiscardAppData();
+      /* Validate input, then write */
+      if (((NVMBACKUP_RX_DATA_IDX(addrSize) + dataLength) > inputLength)
+          || !NvmBackupWriteBlock(NVM_WorkPtr, &pInputBuffer[NVMBACKUP_RX_DATA_IDX(addrSize)], dataLength,
+                                  nvm_storage_size, &written)) {
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueError;
+      } else if ((NVM_WorkPtr + written) >= nvm_storage_size) {
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = (uint8_t)NVMBackupRestoreReturnValueEOF; /* Indicate at EOF */
+      }
+      NvmBackupAddrSet(&(pOutputBuffer[NVMBACKUP_TX_ADDR_IDX]), addrSize, NVM_WorkPtr + written);
+      /* reset data length because there is no data in output buffer. */
+      dataLength = 0;
+    }
+    break;
+
+    case NVMBackupRestoreOperationDigest: /* digest */
+    {
+      const uint8_t pageShift = pInputBuffer[NVMBACKUP_RX_DATA_LEN_IDX];
+      uint8_t pages = 0;
+      if ((false == extended)
+          || (pageShift < NVMBACKUP_DIGEST_PAGE_SHIFT_MIN) || (pageShift > NVMBACKUP_DIGEST_PAGE_SHIFT_MAX)) {
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueError;
+        break;
+      }
+      /* Check that NVM is ready. The digest does not change which operation is in progress */
+      if (NVMBackupRestoreOperationInProgress == NVMBackupRestoreOperationClose) {
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueOperationMismatch;
+        break;
+      }
+      NVM_WorkPtr = NvmBackupAddrGet(&(pInputBuffer[NVMBACKUP_RX_ADDR_IDX]), addrSize);
+      NVM_WorkPtr &= ~(((uint32_t)1 << pageShift) - 1);
+      NvmBackupAddrSet(&(pOutputBuffer[NVMBACKUP_TX_ADDR_IDX]), addrSize, NVM_WorkPtr);
+      if ((NVM_WorkPtr >= nvm_storage_size)
+          || !NvmBackupDigest(NVM_WorkPtr, pageShift, nvm_storage_size, &pOutputBuffer[NVMBACKUP_TX_DATA_IDX(addrSize)],
+                              (uint8_t)(BUF_SIZE_TX - NVMBACKUP_TX_DATA_IDX(addrSize)), &pages)) {
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueError;
+        break;
+      }
+      if ((NVM_WorkPtr + ((uint32_t)pages << pageShift)) >= nvm_storage_size) {
+        pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = (uint8_t)NVMBackupRestoreReturnValueEOF; /* Indicate at EOF */
+      }
+      dataLength = (uint8_t)(pages * NVMBACKUP_STREAM_CRC_SIZE);
+      pOutputBuffer[NVMBACKUP_TX_DATA_LEN_IDX] = dataLength;
+    }
+    break;
+
     case NVMBackupRestoreOperationClose: /* close */
     {
+      NvmBackupStreamStop();
       /* Unlock NVM content, so everyone else can make changes again */
       // here we have to  shut down RF and disable power management
       /* TODO */
@@ -336,6 +807,11 @@ void func_id_serial_api_nvm_backup_restore(__attribute__((unused)) uint8_t input
         break;
       }
       if (NvmBackupClose()) {
+        /* A restore replaces the network the node lists were read from */
+        if (NVMBackupRestoreOperationWrite == NVMBackupRestoreOperationInProgress) {
+          NodeListCacheInvalidate();
+          SendDataTransactionsReset();
+        }
         NVMBackupRestoreOperationInProgress = NVMBackupRestoreOperationClose;
       } else {
         pOutputBuffer[NVMBACKUP_TX_STATUS_IDX] = NVMBackupRestoreReturnValueError; /*report error we canot close backup restore feature*/
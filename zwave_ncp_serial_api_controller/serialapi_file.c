@@ -31,12 +31,19 @@
 #include <zpal_misc.h>
 #include <ZAF_nvm_app.h>
 #include <ZAF_nvm.h>
+#include <AppTimer.h>
+#include <SwTimer.h>
 #include "zw_version_config.h"
 
 #define APPLICATIONSIZE (4 * 1024)
 
 #define APPL_DATA_FILE_SIZE            512
 
+/* Longest time a change of the application data file is kept in RAM before it is written to NVM */
+#if !defined(APPL_DATA_FLUSH_DELAY_MS)
+#define APPL_DATA_FLUSH_DELAY_MS       1000
+#endif
+
 #define APP_VERSION_7_15_3             0x00070F03  // 7.15.3 (NO_20DBM_SUPPORT)
 #define APP_VERSION_7_18_1             0x00071201  /* 7.18.1 - The changes include the capability to set tx power to
                                                     * 20+ dBm over the serial link. */
@@ -55,8 +62,9 @@
  */
 #define APP_CONFIG_FILESYS_VERSION_PRE_SEPARATE_FILESYS_VERSION 0 ///< Version from when the file system version was based solely on the application version
 #define APP_CONFIG_FILESYS_VERSION_SEPARATE_FILESYS_VERSION     1 ///< Version from when the separate file system versioning was added
+#define APP_CONFIG_FILESYS_VERSION_UART_BAUD_RATE               2 ///< Version from when the UART baud rate was added
 
-#define APP_AND_FILESYS_VERSION ((APP_CONFIG_FILESYS_VERSION_SEPARATE_FILESYS_VERSION << 24) | (APP_VERSION << 16) | (APP_REVISION << 8) | APP_PATCH)
+#define APP_AND_FILESYS_VERSION ((APP_CONFIG_FILESYS_VERSION_UART_BAUD_RATE << 24) | (APP_VERSION << 16) | (APP_REVISION << 8) | APP_PATCH)
 
 #define APP_VERSION_GET(version)     (version & 0x00FFFFFF)
 #define FILESYS_VERSION_GET(version) ((uint8_t)(version >> 24))
@@ -100,6 +108,17 @@ typedef struct __attribute__((packed)) SApplicationConfiguration_V7_18_1 {
   zpal_tx_power_t               maxTxPower; // For LR only
 } SApplicationConfiguration_V7_18_1;
 
+//declare the old structure only for the migration process.
+//No variable should be declared with this type (excepted for migration process).
+typedef struct __attribute__((packed)) SApplicationConfiguration_V7_21_0 {
+  zpal_radio_region_t           rfRegion;
+  zpal_tx_power_t               iTxPower;
+  zpal_tx_power_t               ipower0dbmMeasured;
+  uint8_t                       radio_debug_enable;
+  zpal_tx_power_t               maxTxPower; // For LR only
+  eSerialAPISetupNodeIdBaseType nodeIdBaseType;
+} SApplicationConfiguration_V7_21_0;
+
 typedef struct __attribute__((packed)) SApplicationConfiguration  // Must be packet as it is saved on NVM.
 {
   zpal_radio_region_t           rfRegion;
@@ -108,6 +127,7 @@ typedef struct __attribute__((packed)) SApplicationConfiguration  // Must be pac
   uint8_t                       radio_debug_enable;
   zpal_tx_power_t               maxTxPower; // For LR only
   eSerialAPISetupNodeIdBaseType nodeIdBaseType;
+  uint32_t                      uartBaudRate; // 0: default baud rate
 } SApplicationConfiguration;
 
 #define FILE_SIZE_APPLICATIONDATA        (sizeof(SApplicationData))
@@ -244,6 +264,28 @@ SerialAPI_FileSystemMigrationManagement(void)
       presentFilesysVersion = APP_CONFIG_FILESYS_VERSION_SEPARATE_FILESYS_VERSION;
     }
     // New filesys versions are handled here
+    if (presentFilesysVersion < APP_CONFIG_FILESYS_VERSION_UART_BAUD_RATE) {
+      SApplicationConfiguration sAppCfgMigration = { .rfRegion = REGION_UNDEFINED };
+      zpal_status_t status;
+
+      /*Only a new member is appended. Read the legacy structure directly in the new one, then set
+         the default value for the new member.*/
+      status = ZAF_nvm_app_read(FILE_ID_APPLICATIONCONFIGURATION, &sAppCfgMigration,
+                                sizeof(SApplicationConfiguration_V7_21_0));
+      if (ZPAL_STATUS_OK != status) {
+        WriteDefaultApplicationConfiguration();
+      } else {
+        sAppCfgMigration.uartBaudRate = 0;
+
+        status = ZAF_nvm_app_write(FILE_ID_APPLICATIONCONFIGURATION, &sAppCfgMigration,
+                                   sizeof(sAppCfgMigration)); /* Do not use FILE_SIZE_APPLICATIONCONFIGURATION in
+                                                               * migration functions, instead hard-code the size as
+                                                               * sizes do change with FW upgrades. */
+      }
+      if (ZPAL_STATUS_OK == status) {
+        presentFilesysVersion = APP_CONFIG_FILESYS_VERSION_UART_BAUD_RATE;
+      }
+    }
 
     /*
      * If this fails, some of the migrations were not performed due to earlier migrations that have failed.
@@ -314,26 +356,46 @@ bool ObjectExist(zpal_nvm_object_key_t key)
   return true;
 }
 
+/*
+ * RAM copy of the application data file. It is read from NVM on first use. Writes only change the
+ * copy, and all changes made within APPL_DATA_FLUSH_DELAY_MS are written to NVM together.
+ */
+static SApplicationData appDataCache;
+static bool appDataCached = false;
+static bool appDataDirty = false;
+static bool appDataTimerRegistered = false;
+static SSwTimer appDataFlushTimer;
+
+static void ZCB_AppDataFlushTimeout(__attribute__((unused)) SSwTimer *pTimer)
+{
+  SerialApiNvmFlushAppData();
+}
+
+static bool AppDataCacheLoad(void)
+{
+  if (!appDataCached && ObjectExist(FILE_ID_APPLICATIONDATA)) {
+    appDataCached = (ZPAL_STATUS_OK == ZAF_nvm_app_read(FILE_ID_APPLICATIONDATA, &appDataCache, FILE_SIZE_APPLICATIONDATA));
+  }
+  return appDataCached;
+}
+
+static void AppDataFlushTimerStop(void)
+{
+  if (appDataTimerRegistered) {
+    TimerStop(&appDataFlushTimer);
+  }
+}
+
 /**
  * @brief Reads application data from file system.
  */
 uint8_t SerialApiNvmReadAppData(uint32_t offset, uint8_t* pAppData, uint32_t iLength)
 {
-  SApplicationData tApplicationData = { 0 };
-
-  uint8_t dataIsRead = false;
-  zpal_status_t status;
-
-  if (ObjectExist(FILE_ID_APPLICATIONDATA)) {
-    status = ZAF_nvm_app_read(FILE_ID_APPLICATIONDATA, &tApplicationData, FILE_SIZE_APPLICATIONDATA);
-    if (ZPAL_STATUS_OK == status) {
-      dataIsRead = true;
-      for (uint32_t i = 0; i < iLength; i++) {
-        pAppData[i] = tApplicationData.extNvm[i +  offset];
-      }
-    }
+  if ((offset + iLength > APPL_DATA_FILE_SIZE) || !AppDataCacheLoad()) {
+    return false;
   }
-  return dataIsRead;
+  memcpy(pAppData, &appDataCache.extNvm[offset], iLength);
+  return true;
 }
 
 /**
@@ -341,19 +403,45 @@ uint8_t SerialApiNvmReadAppData(uint32_t offset, uint8_t* pAppData, uint32_t iLe
  */
 uint8_t SerialApiNvmWriteAppData(uint32_t offset, const uint8_t* pAppData, uint32_t iLength)
 {
-  SApplicationData tApplicationData = { 0 };
-  uint8_t dataIsWritten = false;
-  zpal_status_t status;
+  if ((offset + iLength > APPL_DATA_FILE_SIZE) || !AppDataCacheLoad()) {
+    return false;
+  }
+  if (0 == memcmp(&appDataCache.extNvm[offset], pAppData, iLength)) {
+    return true;
+  }
+  memcpy(&appDataCache.extNvm[offset], pAppData, iLength);
+  appDataDirty = true;
 
-  status = ZAF_nvm_app_read(FILE_ID_APPLICATIONDATA, &tApplicationData, FILE_SIZE_APPLICATIONDATA);
-  if (ZPAL_STATUS_OK == status) {
-    memcpy((uint8_t *)&tApplicationData + offset, pAppData, iLength);
-    status = ZAF_nvm_app_write(FILE_ID_APPLICATIONDATA, &tApplicationData, FILE_SIZE_APPLICATIONDATA);
-    if (ZPAL_STATUS_OK == status) {
-      dataIsWritten = true;
+  if (!appDataTimerRegistered) {
+    appDataTimerRegistered = AppTimerRegister(&appDataFlushTimer, false, ZCB_AppDataFlushTimeout);
+  }
+  if (!appDataTimerRegistered) {
+    /* No timer to write it back later */
+    return SerialApiNvmFlushAppData();
+  }
+  if (!TimerIsActive(&appDataFlushTimer)) {
+    TimerStart(&appDataFlushTimer, APPL_DATA_FLUSH_DELAY_MS);
+  }
+  return true;
+}
+
+uint8_t SerialApiNvmFlushAppData(void)
+{
+  AppDataFlushTimerStop();
+  if (appDataDirty) {
+    if (ZPAL_STATUS_OK != ZAF_nvm_app_write(FILE_ID_APPLICATIONDATA, &appDataCache, FILE_SIZE_APPLICATIONDATA)) {
+      return false;
     }
+    appDataDirty = false;
   }
-  return dataIsWritten;
+  return true;
+}
+
+void SerialApiNvmDiscardAppData(void)
+{
+  AppDataFlushTimerStop();
+  appDataCached = false;
+  appDataDirty = false;
 }
 
 uint8_t
@@ -660,6 +748,35 @@ ReadApplicationEnablePTI(uint8_t *radio_debug_enable)
   return dataIsRead;
 }
 
+uint8_t
+SaveApplicationUartBaudRate(uint32_t baudRate)
+{
+  SApplicationConfiguration tApplicationConfiguration = { .rfRegion = REGION_UNDEFINED };
+  uint8_t dataIsWritten = false;
+
+  if (ZPAL_STATUS_OK == ZAF_nvm_app_read(FILE_ID_APPLICATIONCONFIGURATION, &tApplicationConfiguration, FILE_SIZE_APPLICATIONCONFIGURATION)) {
+    tApplicationConfiguration.uartBaudRate = baudRate;
+    if (ZPAL_STATUS_OK == ZAF_nvm_app_write(FILE_ID_APPLICATIONCONFIGURATION, &tApplicationConfiguration, FILE_SIZE_APPLICATIONCONFIGURATION)) {
+      dataIsWritten = true;
+    }
+  }
+  return dataIsWritten;
+}
+
+uint8_t
+ReadApplicationUartBaudRate(uint32_t *baudRate)
+{
+  SApplicationConfiguration tApplicationConfiguration = { .rfRegion = REGION_UNDEFINED };
+  uint8_t dataIsRead = false;
+
+  if (ObjectExist(FILE_ID_APPLICATIONCONFIGURATION)
+      && (ZPAL_STATUS_OK == ZAF_nvm_app_read(FILE_ID_APPLICATIONCONFIGURATION, &tApplicationConfiguration, FILE_SIZE_APPLICATIONCONFIGURATION))) {
+    *baudRate = tApplicationConfiguration.uartBaudRate;
+    dataIsRead = true;
+  }
+  return dataIsRead;
+}
+
 uint32_t
 ReadApplicationVersion(void)
 {
@@ -689,6 +806,7 @@ WriteDefaultApplicationData(void)
 {
   //Write default Controller Info file
   SApplicationData tApplicationData = { 0 };
+  SerialApiNvmDiscardAppData();
   ZAF_nvm_app_write(FILE_ID_APPLICATIONDATA, &tApplicationData, sizeof(SApplicationData));
 }
 
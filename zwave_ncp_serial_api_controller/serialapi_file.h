@@ -34,6 +34,21 @@ uint8_t SerialApiNvmReadAppData(uint32_t offset, uint8_t* pAppData, uint32_t iLe
  */
 uint8_t SerialApiNvmWriteAppData(uint32_t offset, const uint8_t* pAppData, uint32_t iLength);
 
+/**
+ * @brief Writes pending application data changes to file system.
+ *
+ * Changes made by SerialApiNvmWriteAppData() are written after a short delay. This must be called
+ * before anything that needs the file to be up to date in NVM, like a reset or an NVM backup.
+ */
+uint8_t SerialApiNvmFlushAppData(void);
+
+/**
+ * @brief Drops the RAM copy of the application data, including pending changes.
+ *
+ * Must be called when the file is changed in NVM by other means, like an NVM restore.
+ */
+void SerialApiNvmDiscardAppData(void);
+
 uint8_t
 SaveApplicationSettings(uint8_t bListening,
                         uint8_t bGeneric,
@@ -126,6 +141,24 @@ SaveApplicationEnablePTI(uint8_t radio_debug_enable);
 uint8_t
 ReadApplicationEnablePTI(uint8_t *radio_debug_enable);
 
+/**
+ * @brief Writes the SerialAPI UART baud rate to file system
+ *
+ * @param baudRate  baud rate to use after reset, 0 selects the default rate
+ * @return value was saved correctly
+ */
+uint8_t
+SaveApplicationUartBaudRate(uint32_t baudRate);
+
+/**
+ * @brief Reads the SerialAPI UART baud rate from file system
+ *
+ * @param baudRate  pointer to the baud rate, 0 if the default rate is used
+ * @return value was read correctly
+ */
+uint8_t
+ReadApplicationUartBaudRate(uint32_t *baudRate);
+
 /**
  * @brief Reads the application version from NVM
  */
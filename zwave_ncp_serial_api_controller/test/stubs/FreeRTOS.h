@@ -0,0 +1,5 @@
+/* Host stand-in: the tests run in a single thread */
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#endif /* INC_FREERTOS_H */
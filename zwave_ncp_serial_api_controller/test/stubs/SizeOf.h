@@ -0,0 +1,7 @@
+/* Host stand-in for the Z-Wave SDK header */
+#ifndef _SIZEOF_H_
+#define _SIZEOF_H_
+
+#define sizeof_array(ARRAY) ((sizeof ARRAY) / (sizeof ARRAY[0]))
+
+#endif /* _SIZEOF_H_ */
@@ -0,0 +1,10 @@
+/* Host stand-in for the Z-Wave SDK header, enough for app.h built with UNIT_TEST */
+#ifndef _ZW_H_
+#define _ZW_H_
+
+#define ZW_SET_LEARN_MODE_DISABLE   0x00
+#define ZW_SET_LEARN_MODE_CLASSIC   0x01
+#define ZW_SET_LEARN_MODE_NWI       0x02
+#define ZW_SET_LEARN_MODE_NWE       0x03
+
+#endif /* _ZW_H_ */
@@ -0,0 +1,9 @@
+/* Host stand-in for the Z-Wave SDK header, enough for app.h built with UNIT_TEST */
+#ifndef _ZW_TYPEDEFS_H_
+#define _ZW_TYPEDEFS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#endif /* _ZW_TYPEDEFS_H_ */
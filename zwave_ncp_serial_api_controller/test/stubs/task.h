@@ -0,0 +1,8 @@
+/* Host stand-in: the tests run in a single thread, critical sections are not needed */
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+#endif /* INC_TASK_H */
@@ -0,0 +1,10 @@
+/* Host stand-in: log calls are compiled out */
+#ifndef ZPAL_LOG_H_
+#define ZPAL_LOG_H_
+
+#define ZPAL_LOG_DEBUG(...)
+#define ZPAL_LOG_INFO(...)
+#define ZPAL_LOG_WARNING(...)
+#define ZPAL_LOG_ERROR(...)
+
+#endif /* ZPAL_LOG_H_ */
@@ -0,0 +1,40 @@
+/**
+ * @file
+ * Minimal assertions for the host unit tests.
+ *
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int test_failures;
+
+#define TEST_ASSERT(cond)                                                        \
+  do {                                                                           \
+    if (!(cond)) {                                                               \
+      printf("%s:%d: %s: assertion failed: %s\n", __FILE__, __LINE__, __func__, #cond); \
+      test_failures++;                                                           \
+    }                                                                            \
+  } while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual)                                      \
+  do {                                                                           \
+    long long e_ = (long long)(expected);                                        \
+    long long a_ = (long long)(actual);                                          \
+    if (e_ != a_) {                                                              \
+      printf("%s:%d: %s: expected %s == %lld, got %lld\n", __FILE__, __LINE__, __func__, #actual, e_, a_); \
+      test_failures++;                                                           \
+    }                                                                            \
+  } while (0)
+
+#define TEST_RUN(test)  test()
+
+/* Exit status of the test program */
+#define TEST_RESULT()                                                            \
+  ((0 == test_failures) ? (printf("%s: ok\n", __FILE__), EXIT_SUCCESS)           \
+                        : (printf("%s: %d failure(s)\n", __FILE__, test_failures), EXIT_FAILURE))
+
+#endif /* _TEST_H_ */
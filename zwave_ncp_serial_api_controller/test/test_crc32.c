@@ -0,0 +1,58 @@
+/**
+ * @file
+ * Host unit tests of crc32_update().
+ *
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#include <string.h>
+#include "crc32.h"
+#include "test.h"
+
+static const uint8_t check[] = "123456789";
+
+static void test_empty(void)
+{
+  TEST_ASSERT_EQUAL(0x00000000, crc32_update(0, check, 0));
+}
+
+/* Check value of CRC-32/ISO-HDLC, the zlib crc32() */
+static void test_check_value(void)
+{
+  TEST_ASSERT_EQUAL(0xCBF43926, crc32_update(0, check, 9));
+}
+
+static void test_known_vectors(void)
+{
+  static const uint8_t zero[1] = { 0x00 };
+  static const uint8_t erased[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+  static const char fox[] = "The quick brown fox jumps over the lazy dog";
+
+  TEST_ASSERT_EQUAL(0xD202EF8D, crc32_update(0, zero, sizeof(zero)));
+  TEST_ASSERT_EQUAL(0xFFFFFFFF, crc32_update(0, erased, sizeof(erased)));
+  TEST_ASSERT_EQUAL(0x414FA339, crc32_update(0, (const uint8_t *)fox, (uint32_t)strlen(fox)));
+}
+
+/* Any split of the data gives the CRC of the whole */
+static void test_incremental(void)
+{
+  uint8_t data[300];
+  for (uint32_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)((i * 7) + (i >> 3));
+  }
+  const uint32_t whole = crc32_update(0, data, sizeof(data));
+
+  for (uint32_t split = 0; split <= sizeof(data); split++) {
+    uint32_t crc = crc32_update(0, data, split);
+    crc = crc32_update(crc, &data[split], (uint32_t)(sizeof(data) - split));
+    TEST_ASSERT_EQUAL(whole, crc);
+  }
+}
+
+int main(void)
+{
+  TEST_RUN(test_empty);
+  TEST_RUN(test_check_value);
+  TEST_RUN(test_known_vectors);
+  TEST_RUN(test_incremental);
+  return TEST_RESULT();
+}
@@ -0,0 +1,188 @@
+/**
+ * @file
+ * Host unit tests of the NVM backup codec.
+ *
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#include <string.h>
+#include "nvm_backup_codec.h"
+#include "test.h"
+
+#define BLOCK_SIZE      2048
+#define OUT_SIZE        160     // NVM backup frames carry at most this much encoded data
+#define RANDOM_BLOCKS   20000
+
+static uint8_t raw[BLOCK_SIZE];
+static uint8_t decoded[BLOCK_SIZE];
+static uint8_t out[UINT8_MAX];
+
+static uint32_t random_state = 1;
+
+/* Deterministic, so a failure can be reproduced */
+static uint32_t random_next(void)
+{
+  random_state = (random_state * 1103515245u) + 12345u;
+  return random_state >> 8;
+}
+
+/**
+ * Encode the whole of raw[0..length) in blocks of at most outSize bytes and decode them again.
+ *
+ * @return Number of encoded bytes.
+ */
+static uint32_t round_trip(uint16_t length, uint8_t outSize)
+{
+  uint16_t pos = 0;
+  uint32_t encoded = 0;
+
+  while (pos < length) {
+    uint8_t outLength = 0;
+    uint16_t rawLength = 0;
+    const uint16_t consumed = nvm_backup_encode(&raw[pos], (uint16_t)(length - pos), out, outSize, &outLength);
+
+    TEST_ASSERT(0 < consumed);
+    TEST_ASSERT(outLength <= outSize);
+    if (0 == consumed) {
+      break;
+    }
+    TEST_ASSERT(nvm_backup_decode(out, outLength, &decoded[pos], (uint16_t)(BLOCK_SIZE - pos), &rawLength));
+    TEST_ASSERT_EQUAL(consumed, rawLength);
+    pos = (uint16_t)(pos + consumed);
+    encoded += outLength;
+  }
+  TEST_ASSERT(0 == memcmp(raw, decoded, length));
+  return encoded;
+}
+
+static void test_empty(void)
+{
+  uint8_t outLength = 1;
+  uint16_t rawLength = 1;
+
+  TEST_ASSERT_EQUAL(0, nvm_backup_encode(raw, 0, out, OUT_SIZE, &outLength));
+  TEST_ASSERT_EQUAL(0, outLength);
+  TEST_ASSERT(nvm_backup_decode(out, 0, decoded, BLOCK_SIZE, &rawLength));
+  TEST_ASSERT_EQUAL(0, rawLength);
+}
+
+/* Erased flash is two bytes per run */
+static void test_erased(void)
+{
+  uint8_t outLength = 0;
+
+  memset(raw, NVM_BACKUP_CODEC_ERASED, BLOCK_SIZE);
+  TEST_ASSERT_EQUAL(BLOCK_SIZE, nvm_backup_encode(raw, BLOCK_SIZE, out, OUT_SIZE, &outLength));
+  TEST_ASSERT_EQUAL(2, outLength);
+  TEST_ASSERT_EQUAL(2, round_trip(BLOCK_SIZE, OUT_SIZE));
+}
+
+/* A repeated pattern is encoded as overlapping copies */
+static void test_repeated(void)
+{
+  for (uint16_t i = 0; i < BLOCK_SIZE; i++) {
+    raw[i] = (uint8_t)(0x10 + (i % 12));
+  }
+  TEST_ASSERT(round_trip(BLOCK_SIZE, OUT_SIZE) < (BLOCK_SIZE / 8));
+}
+
+/* Data that does not compress still round trips, at one extra byte per 128 literals and per block */
+static void test_incompressible(void)
+{
+  const uint32_t blocks = (BLOCK_SIZE / (OUT_SIZE - 2)) + 1;
+
+  random_state = 7;
+  for (uint16_t i = 0; i < BLOCK_SIZE; i++) {
+    raw[i] = (uint8_t)random_next();
+  }
+  TEST_ASSERT(round_trip(BLOCK_SIZE, OUT_SIZE) <= (BLOCK_SIZE + (2u * blocks)));
+}
+
+/* Random mixes of literals, erased runs and repeats, in small and large output buffers */
+static void test_random_round_trips(void)
+{
+  random_state = 1;
+  for (uint32_t n = 0; n < RANDOM_BLOCKS; n++) {
+    const uint16_t length = (uint16_t)(random_next() % (BLOCK_SIZE + 1));
+    uint16_t i = 0;
+
+    while (i < length) {
+      uint16_t run = (uint16_t)(1 + (random_next() % 80));
+      if (run > (length - i)) {
+        run = (uint16_t)(length - i);
+      }
+      switch (random_next() % 4) {
+        case 0:
+          memset(&raw[i], NVM_BACKUP_CODEC_ERASED, run);
+          break;
+        case 1:
+          memset(&raw[i], (uint8_t)random_next(), run);
+          break;
+        case 2:
+          if (i) {
+            const uint16_t from = (uint16_t)(random_next() % i);
+            for (uint16_t k = 0; k < run; k++) {
+              raw[i + k] = raw[from + k];
+            }
+            break;
+          }
+          /* Nothing to repeat yet */
+          __attribute__((fallthrough));
+        default:
+          for (uint16_t k = 0; k < run; k++) {
+            raw[i + k] = (uint8_t)random_next();
+          }
+          break;
+      }
+      i = (uint16_t)(i + run);
+    }
+    round_trip(length, (uint8_t)(4 + (random_next() % (UINT8_MAX - 3))));
+  }
+}
+
+static void test_decode_malformed(void)
+{
+  uint16_t rawLength = 0;
+
+  /* Literal running past the input */
+  static const uint8_t literal[] = { 0x03, 0x01, 0x02 };
+  TEST_ASSERT(!nvm_backup_decode(literal, sizeof(literal), decoded, BLOCK_SIZE, &rawLength));
+
+  /* Erased run without its length byte */
+  static const uint8_t erased[] = { 0x80 };
+  TEST_ASSERT(!nvm_backup_decode(erased, sizeof(erased), decoded, BLOCK_SIZE, &rawLength));
+
+  /* Copy from before the start of the block */
+  static const uint8_t copy[] = { 0x00, 0xAA, 0xC0, 0x00, 0x02 };
+  TEST_ASSERT(!nvm_backup_decode(copy, sizeof(copy), decoded, BLOCK_SIZE, &rawLength));
+
+  /* Copy with distance 0 */
+  static const uint8_t copy_zero[] = { 0x00, 0xAA, 0xC0, 0x00, 0x00 };
+  TEST_ASSERT(!nvm_backup_decode(copy_zero, sizeof(copy_zero), decoded, BLOCK_SIZE, &rawLength));
+
+  /* Copy without its distance */
+  static const uint8_t copy_short[] = { 0x00, 0xAA, 0xC0, 0x00 };
+  TEST_ASSERT(!nvm_backup_decode(copy_short, sizeof(copy_short), decoded, BLOCK_SIZE, &rawLength));
+
+  /* More data than the output holds */
+  static const uint8_t too_long[] = { 0xBF, 0xFF };
+  TEST_ASSERT(!nvm_backup_decode(too_long, sizeof(too_long), decoded, BLOCK_SIZE, &rawLength));
+
+  /* A copy of one byte back repeats it */
+  static const uint8_t run[] = { 0x00, 0xAA, 0xC0, 0x00, 0x01 };
+  TEST_ASSERT(nvm_backup_decode(run, sizeof(run), decoded, BLOCK_SIZE, &rawLength));
+  TEST_ASSERT_EQUAL(5, rawLength);
+  for (uint8_t i = 0; i < 5; i++) {
+    TEST_ASSERT_EQUAL(0xAA, decoded[i]);
+  }
+}
+
+int main(void)
+{
+  TEST_RUN(test_empty);
+  TEST_RUN(test_erased);
+  TEST_RUN(test_repeated);
+  TEST_RUN(test_incompressible);
+  TEST_RUN(test_random_round_trips);
+  TEST_RUN(test_decode_malformed);
+  return TEST_RESULT();
+}
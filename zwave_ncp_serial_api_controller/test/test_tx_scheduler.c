@@ -0,0 +1,202 @@
+/**
+ * @file
+ * Host unit tests of the tx scheduler ranking, depth limits and slot pools.
+ *
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#include <string.h>
+#include "tx_scheduler.h"
+#include "comm_interface.h"
+#include "app.h"
+#include "test.h"
+
+/* Test double, the tests only read back the function ID and the payload */
+uint8_t comm_interface_frame_build(uint8_t *frame, uint8_t cmd, uint8_t type, uint8_t len)
+{
+  frame[FRAME_SOF_IDX] = SOF;
+  frame[FRAME_LEN_IDX] = (uint8_t)(len + 3);
+  frame[FRAME_TYPE_IDX] = type;
+  frame[FRAME_CMD_IDX] = cmd;
+  frame[FRAME_HEADER_LEN + len] = 0;
+  return FRAME_BUFFER_SIZE(len);
+}
+
+static uint8_t payload[BUF_SIZE_TX];
+
+static bool enqueue(tx_class_t cls, uint8_t cmd)
+{
+  return tx_scheduler_enqueue(cls, cmd, payload, 1);
+}
+
+/* Transmit the next frame and acknowledge it at once, returning its function ID */
+static uint8_t next_cmd(void)
+{
+  const uint8_t slot = tx_scheduler_next();
+  if (TX_SCHEDULER_NONE == slot) {
+    return 0;
+  }
+  const uint8_t cmd = tx_scheduler_frame(slot)[FRAME_CMD_IDX];
+  tx_scheduler_release(slot);
+  return cmd;
+}
+
+static void test_empty(void)
+{
+  tx_scheduler_init();
+  TEST_ASSERT(!tx_scheduler_pending());
+  TEST_ASSERT_EQUAL(TX_SCHEDULER_NONE, tx_scheduler_next());
+}
+
+static void test_fifo_within_class(void)
+{
+  tx_scheduler_init();
+  for (uint8_t cmd = 1; cmd <= 5; cmd++) {
+    TEST_ASSERT(enqueue(TX_CLASS_CALLBACK, cmd));
+  }
+  for (uint8_t cmd = 1; cmd <= 5; cmd++) {
+    TEST_ASSERT_EQUAL(cmd, next_cmd());
+  }
+  TEST_ASSERT(!tx_scheduler_pending());
+}
+
+static void test_priority(void)
+{
+  tx_scheduler_init();
+  TEST_ASSERT(enqueue(TX_CLASS_APP_COMMAND, 0x30));
+  TEST_ASSERT(enqueue(TX_CLASS_NODE_UPDATE, 0x20));
+  TEST_ASSERT(enqueue(TX_CLASS_CALLBACK, 0x10));
+  TEST_ASSERT_EQUAL(0x10, next_cmd());
+  TEST_ASSERT_EQUAL(0x20, next_cmd());
+  TEST_ASSERT_EQUAL(0x30, next_cmd());
+}
+
+/* A waiting class moves up one class every TX_SCHEDULER_AGING_STEP frames let past */
+static void test_aging(void)
+{
+  const uint8_t callbacks = 20;
+  /* Ranks class * TX_SCHEDULER_AGING_STEP - age, the lowest rank wins and ties go to the higher class */
+  const uint8_t let_past = (uint8_t)((TX_CLASS_APP_COMMAND * TX_SCHEDULER_AGING_STEP) + 1);
+  uint8_t position = 0;
+
+  tx_scheduler_init();
+  TEST_ASSERT(enqueue(TX_CLASS_APP_COMMAND, 0x30));
+  for (uint8_t i = 0; i < callbacks; i++) {
+    TEST_ASSERT(enqueue(TX_CLASS_CALLBACK, 0x10));
+  }
+  while (0x30 != next_cmd()) {
+    position++;
+    TEST_ASSERT(position <= callbacks);
+  }
+  TEST_ASSERT_EQUAL(let_past, position);
+}
+
+/* Every class gets served while a higher class stays busy */
+static void test_no_starvation(void)
+{
+  uint8_t served[TX_CLASS_COUNT] = { 0 };
+
+  tx_scheduler_init();
+  for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+    TEST_ASSERT(enqueue((tx_class_t)c, c));
+  }
+  for (uint8_t n = 0; n < 60; n++) {
+    const uint8_t slot = tx_scheduler_next();
+    TEST_ASSERT(TX_SCHEDULER_NONE != slot);
+    if (TX_SCHEDULER_NONE == slot) {
+      break;
+    }
+    const uint8_t c = tx_scheduler_frame(slot)[FRAME_CMD_IDX];
+    tx_scheduler_release(slot);
+    served[c]++;
+    /* Keep every class busy */
+    TEST_ASSERT(enqueue((tx_class_t)c, c));
+  }
+  for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+    TEST_ASSERT(served[c] > 0);
+  }
+  TEST_ASSERT(served[TX_CLASS_CALLBACK] > served[TX_CLASS_APP_COMMAND]);
+}
+
+/* Frames in flight count towards the depth limit until released */
+static void test_depth_limit(void)
+{
+  tx_scheduler_init();
+  tx_scheduler_stats_reset();
+  for (uint8_t i = 0; i < TX_SCHEDULER_DEPTH_NODE_UPDATE; i++) {
+    TEST_ASSERT(enqueue(TX_CLASS_NODE_UPDATE, i));
+  }
+  TEST_ASSERT(!tx_scheduler_has_room(TX_CLASS_NODE_UPDATE, 1));
+  TEST_ASSERT(!enqueue(TX_CLASS_NODE_UPDATE, 0xFF));
+  TEST_ASSERT_EQUAL(1, tx_scheduler_dropped(TX_CLASS_NODE_UPDATE));
+  TEST_ASSERT_EQUAL(TX_SCHEDULER_DEPTH_NODE_UPDATE, tx_scheduler_high_water(TX_CLASS_NODE_UPDATE));
+  /* Another class is not affected */
+  TEST_ASSERT(enqueue(TX_CLASS_CALLBACK, 0x10));
+
+  const uint8_t slot = tx_scheduler_next();   // callback
+  tx_scheduler_release(slot);
+  const uint8_t inFlight = tx_scheduler_next();
+  TEST_ASSERT(!tx_scheduler_has_room(TX_CLASS_NODE_UPDATE, 1));
+  tx_scheduler_release(inFlight);
+  TEST_ASSERT(tx_scheduler_has_room(TX_CLASS_NODE_UPDATE, 1));
+
+  tx_scheduler_stats_reset();
+  TEST_ASSERT_EQUAL(0, tx_scheduler_dropped(TX_CLASS_NODE_UPDATE));
+  TEST_ASSERT_EQUAL(TX_SCHEDULER_DEPTH_NODE_UPDATE - 1, tx_scheduler_high_water(TX_CLASS_NODE_UPDATE));
+}
+
+/* Frames take the smallest pool they fit in and spill into larger ones */
+static void test_pools(void)
+{
+  uint8_t slots[TX_SCHEDULER_SLOTS];
+  uint8_t count = 0;
+
+  for (uint16_t i = 0; i < sizeof(payload); i++) {
+    payload[i] = (uint8_t)i;
+  }
+  tx_scheduler_init();
+  TEST_ASSERT(tx_scheduler_enqueue(TX_CLASS_CALLBACK, 0x01, payload, BUF_SIZE_TX));
+  slots[0] = tx_scheduler_next();
+  TEST_ASSERT(0 == memcmp(FRAME_PAYLOAD(tx_scheduler_frame(slots[0])), payload, BUF_SIZE_TX));
+  tx_scheduler_release(slots[0]);
+
+  /* Only the large pool holds BUF_SIZE_TX, more than that many are refused */
+  tx_scheduler_init();
+  for (uint8_t i = 0; i < TX_SCHEDULER_LARGE_SLOTS; i++) {
+    TEST_ASSERT(tx_scheduler_enqueue(TX_CLASS_CALLBACK, i, payload, BUF_SIZE_TX));
+  }
+  TEST_ASSERT(!tx_scheduler_has_room(TX_CLASS_CALLBACK, BUF_SIZE_TX));
+  TEST_ASSERT(tx_scheduler_has_room(TX_CLASS_CALLBACK, TX_SCHEDULER_MEDIUM_PAYLOAD));
+
+  /* Small frames fill each class up to its depth, spilling from the small into the medium pool */
+  tx_scheduler_init();
+  for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+    while (tx_scheduler_has_room((tx_class_t)c, 1)) {
+      TEST_ASSERT(enqueue((tx_class_t)c, count));
+      count++;
+    }
+  }
+  TEST_ASSERT_EQUAL(TX_SCHEDULER_DEPTH_CALLBACK + TX_SCHEDULER_DEPTH_NODE_UPDATE + TX_SCHEDULER_DEPTH_APP_COMMAND, count);
+  for (uint8_t i = 0; i < count; i++) {
+    slots[i] = tx_scheduler_next();
+    TEST_ASSERT(TX_SCHEDULER_NONE != slots[i]);
+    for (uint8_t k = 0; k < i; k++) {
+      TEST_ASSERT(slots[i] != slots[k]);
+    }
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    tx_scheduler_release(slots[i]);
+  }
+  TEST_ASSERT(tx_scheduler_has_room(TX_CLASS_CALLBACK, BUF_SIZE_TX));
+}
+
+int main(void)
+{
+  TEST_RUN(test_empty);
+  TEST_RUN(test_fifo_within_class);
+  TEST_RUN(test_priority);
+  TEST_RUN(test_aging);
+  TEST_RUN(test_no_starvation);
+  TEST_RUN(test_depth_limit);
+  TEST_RUN(test_pools);
+  return TEST_RESULT();
+}
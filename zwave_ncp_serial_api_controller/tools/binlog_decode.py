@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Decode the binary log records written by binlog.c back into text.
+
+The format strings are not part of the records, only their addresses. They are read from the ELF
+file of the build that produced the log, so the same ELF file must be used for decoding.
+
+Bytes on the log channel that are not binary records, like ZPAL_LOG_INFO() text, are passed
+through unchanged.
+
+Usage:
+  binlog_decode.py zwave_ncp_serial_api_controller.out capture.bin
+  cat /dev/ttyACM0 | binlog_decode.py zwave_ncp_serial_api_controller.out
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+BINLOG_SYNC = b'\xA5\x5A'
+BINLOG_MAX_ARGS = 5
+HEADER_SIZE = 11
+
+SHT_PROGBITS = 1
+SHF_ALLOC = 0x2
+
+# printf conversion, with flags, width, precision and length modifiers
+CONVERSION = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diouxXcsp%])')
+
+
+class Elf:
+  """Read only access to the allocated sections of a 32 bit little endian ELF file."""
+
+  def __init__(self, path):
+    with open(path, 'rb') as f:
+      data = f.read()
+    if data[:4] != b'\x7fELF' or data[4] != 1 or data[5] != 1:
+      raise ValueError('%s is not a 32 bit little endian ELF file' % path)
+    shoff, = struct.unpack_from('<I', data, 0x20)
+    shentsize, shnum = struct.unpack_from('<HH', data, 0x2E)
+    self.sections = []
+    for i in range(shnum):
+      _, sh_type, flags, addr, offset, size = struct.unpack_from('<IIIIII', data, shoff + i * shentsize)
+      if sh_type == SHT_PROGBITS and (flags & SHF_ALLOC) and addr:
+        self.sections.append((addr, data[offset:offset + size]))
+
+  def string(self, address):
+    for addr, content in self.sections:
+      if addr <= address < addr + len(content):
+        start = address - addr
+        end = content.find(b'\0', start)
+        return content[start:end if end >= 0 else len(content)].decode('ascii', 'replace')
+    return None
+
+
+def format_record(elf, fmt_address, args):
+  if fmt_address == 0:
+    return '%d log records lost so far\n' % args[0]
+  fmt = elf.string(fmt_address)
+  if fmt is None:
+    return '<unknown format 0x%08X> %s\n' % (fmt_address, ' '.join('0x%08X' % a for a in args))
+
+  args = list(args)
+
+  def convert(match):
+    spec, _, conversion = match.groups()
+    if conversion == '%':
+      return '%'
+    value = args.pop(0) if args else 0
+    if conversion == 's':
+      text = elf.string(value)
+      return ('%' + spec + 's') % (text if text is not None else '<0x%08X>' % value)
+    if conversion == 'p':
+      return '0x%08X' % value
+    if conversion in 'di' and value & 0x80000000:
+      value -= 1 << 32
+    if conversion in 'ou':
+      conversion = 'd' if conversion == 'u' else 'o'
+    return ('%' + spec + conversion) % value
+
+  return CONVERSION.sub(convert, fmt)
+
+
+def decode(elf, stream, out):
+  buffer = b''
+  while True:
+    chunk = stream.read1(256)
+    if chunk:
+      buffer += chunk
+    while buffer:
+      sync = buffer.find(BINLOG_SYNC)
+      if sync < 0:
+        # Keep a trailing first sync byte, the second one may follow in the next chunk
+        keep = 1 if buffer[-1:] == BINLOG_SYNC[:1] else 0
+        out.write(buffer[:len(buffer) - keep].decode('ascii', 'replace'))
+        buffer = buffer[len(buffer) - keep:]
+        break
+      if sync:
+        out.write(buffer[:sync].decode('ascii', 'replace'))
+        buffer = buffer[sync:]
+      if len(buffer) < HEADER_SIZE:
+        break
+      nargs = buffer[2]
+      if nargs > BINLOG_MAX_ARGS:
+        # Not a record, pass the sync bytes on as text
+        out.write(buffer[:1].decode('ascii', 'replace'))
+        buffer = buffer[1:]
+        continue
+      size = HEADER_SIZE + 4 * nargs
+      if len(buffer) < size:
+        break
+      fmt_address, timestamp = struct.unpack_from('<II', buffer, 3)
+      args = struct.unpack_from('<%dI' % nargs, buffer, HEADER_SIZE)
+      out.write('[%10u] %s' % (timestamp, format_record(elf, fmt_address, args)))
+      buffer = buffer[size:]
+    out.flush()
+    if not chunk:
+      out.write(buffer.decode('ascii', 'replace'))
+      return
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+  parser.add_argument('elf', help='ELF file of the firmware that wrote the log')
+  parser.add_argument('input', nargs='?', help='captured log channel output, stdin if omitted')
+  options = parser.parse_args()
+
+  elf = Elf(options.elf)
+  if options.input:
+    with open(options.input, 'rb') as stream:
+      decode(elf, stream, sys.stdout)
+  else:
+    decode(elf, sys.stdin.buffer, sys.stdout)
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,250 @@
+/**
+ * @file
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#include <string.h>
+#include <assert.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "tx_scheduler.h"
+#include "comm_interface.h"
+#include "app.h"
+#include "SizeOf.h"
+#include "zpal_log.h"
+
+#define SLOT_NONE TX_SCHEDULER_NONE
+
+_Static_assert(TX_SCHEDULER_SLOTS < SLOT_NONE, "STATIC_ASSERT_TX_SCHEDULER_SLOTS_to_big");
+_Static_assert(TX_SCHEDULER_SMALL_PAYLOAD <= TX_SCHEDULER_MEDIUM_PAYLOAD, "STATIC_ASSERT_TX_SCHEDULER_pool_order");
+_Static_assert(TX_SCHEDULER_MEDIUM_PAYLOAD <= BUF_SIZE_TX, "STATIC_ASSERT_TX_SCHEDULER_pool_order");
+
+typedef enum {
+  POOL_SMALL,
+  POOL_MEDIUM,
+  POOL_LARGE,
+  POOL_COUNT
+} tx_pool_t;
+
+typedef struct {
+  uint8_t next;       // next slot in the class queue or in the free list
+  uint8_t cls;
+} tx_slot_t;
+
+typedef struct {
+  uint8_t *storage;
+  uint8_t stride;     // FRAME_BUFFER_SIZE() of the largest payload
+  uint8_t first;      // index of the first slot of the pool
+  uint8_t count;
+} tx_pool_info_t;
+
+typedef struct {
+  uint8_t head;       // oldest queued frame
+  uint8_t tail;       // newest queued frame
+  uint8_t queued;     // frames waiting to be transmitted
+  uint8_t allocated;  // queued frames and frames in flight
+  uint8_t age;        // frames let past while this class was waiting
+  uint8_t high_water; // most frames allocated at once
+  uint32_t dropped;
+} tx_class_queue_t;
+
+static const uint8_t class_depth[TX_CLASS_COUNT] = {
+  [TX_CLASS_CALLBACK]    = TX_SCHEDULER_DEPTH_CALLBACK,
+  [TX_CLASS_NODE_UPDATE] = TX_SCHEDULER_DEPTH_NODE_UPDATE,
+  [TX_CLASS_APP_COMMAND] = TX_SCHEDULER_DEPTH_APP_COMMAND,
+};
+
+static uint8_t storage_small[TX_SCHEDULER_SMALL_SLOTS][FRAME_BUFFER_SIZE(TX_SCHEDULER_SMALL_PAYLOAD)];
+static uint8_t storage_medium[TX_SCHEDULER_MEDIUM_SLOTS][FRAME_BUFFER_SIZE(TX_SCHEDULER_MEDIUM_PAYLOAD)];
+static uint8_t storage_large[TX_SCHEDULER_LARGE_SLOTS][FRAME_BUFFER_SIZE(BUF_SIZE_TX)];
+
+static const tx_pool_info_t pools[POOL_COUNT] = {
+  [POOL_SMALL]  = { &storage_small[0][0], FRAME_BUFFER_SIZE(TX_SCHEDULER_SMALL_PAYLOAD), 0, TX_SCHEDULER_SMALL_SLOTS },
+  [POOL_MEDIUM] = { &storage_medium[0][0], FRAME_BUFFER_SIZE(TX_SCHEDULER_MEDIUM_PAYLOAD), TX_SCHEDULER_SMALL_SLOTS, TX_SCHEDULER_MEDIUM_SLOTS },
+  [POOL_LARGE]  = { &storage_large[0][0], FRAME_BUFFER_SIZE(BUF_SIZE_TX), TX_SCHEDULER_SMALL_SLOTS + TX_SCHEDULER_MEDIUM_SLOTS, TX_SCHEDULER_LARGE_SLOTS },
+};
+
+static tx_slot_t slots[TX_SCHEDULER_SLOTS];
+static tx_class_queue_t class_queue[TX_CLASS_COUNT];
+static uint8_t free_head[POOL_COUNT] = { SLOT_NONE, SLOT_NONE, SLOT_NONE };
+
+static tx_pool_t slot_pool(uint8_t slot)
+{
+  tx_pool_t pool = POOL_SMALL;
+  while (slot >= (pools[pool].first + pools[pool].count)) {
+    pool++;
+  }
+  return pool;
+}
+
+/* Smallest pool with a free slot holding len bytes of payload. Called in critical section. */
+static tx_pool_t pool_find(uint8_t len)
+{
+  tx_pool_t pool = POOL_SMALL;
+  while ((pool < POOL_COUNT)
+         && ((FRAME_BUFFER_SIZE(len) > pools[pool].stride) || (SLOT_NONE == free_head[pool]))) {
+    pool++;
+  }
+  return pool;
+}
+
+/* Take a slot from the smallest pool holding len bytes of payload. Called in critical section. */
+static uint8_t slot_alloc(uint8_t len)
+{
+  tx_pool_t pool = pool_find(len);
+  if (POOL_COUNT == pool) {
+    return SLOT_NONE;
+  }
+  uint8_t slot = free_head[pool];
+  free_head[pool] = slots[slot].next;
+  return slot;
+}
+
+void tx_scheduler_init(void)
+{
+  taskENTER_CRITICAL();
+  for (tx_pool_t pool = POOL_SMALL; pool < POOL_COUNT; pool++) {
+    uint8_t end = pools[pool].first + pools[pool].count;
+    for (uint8_t i = pools[pool].first; i < end; i++) {
+      slots[i].next = ((i + 1) < end) ? (uint8_t)(i + 1) : SLOT_NONE;
+    }
+    free_head[pool] = pools[pool].count ? pools[pool].first : SLOT_NONE;
+  }
+  for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+    class_queue[c] = (tx_class_queue_t) { .head = SLOT_NONE, .tail = SLOT_NONE };
+  }
+  taskEXIT_CRITICAL();
+}
+
+bool tx_scheduler_enqueue(tx_class_t cls, uint8_t cmd, const uint8_t *pData, uint8_t len)
+{
+  assert(cls < TX_CLASS_COUNT);
+  if (len > (uint8_t)BUF_SIZE_TX) {
+    assert((uint8_t)BUF_SIZE_TX >= len);
+    len = (uint8_t)BUF_SIZE_TX;
+  }
+
+  taskENTER_CRITICAL();
+  tx_class_queue_t *queue = &class_queue[cls];
+  uint8_t slot = (queue->allocated < class_depth[cls]) ? slot_alloc(len) : SLOT_NONE;
+  if (SLOT_NONE == slot) {
+    queue->dropped++;
+    taskEXIT_CRITICAL();
+    ZPAL_LOG_WARNING(ZPAL_LOG_APP, "%s: class %d full, CMD = 0x%02X dropped\r\n", __FUNCTION__, cls, cmd);
+    return false;
+  }
+
+  uint8_t *frame = tx_scheduler_frame(slot);
+  memcpy(FRAME_PAYLOAD(frame), pData, len);
+  comm_interface_frame_build(frame, cmd, REQUEST, len);
+  slots[slot].next = SLOT_NONE;
+  slots[slot].cls = (uint8_t)cls;
+
+  if (SLOT_NONE == queue->tail) {
+    queue->head = slot;
+  } else {
+    slots[queue->tail].next = slot;
+  }
+  queue->tail = slot;
+  queue->queued++;
+  queue->allocated++;
+  if (queue->allocated > queue->high_water) {
+    queue->high_water = queue->allocated;
+  }
+  taskEXIT_CRITICAL();
+  return true;
+}
+
+uint8_t tx_scheduler_next(void)
+{
+  uint8_t slot = SLOT_NONE;
+  int16_t best_rank = INT16_MAX;
+  uint8_t best = TX_CLASS_COUNT;
+
+  taskENTER_CRITICAL();
+  /* Each class is ranked by its priority, lowered by how long it has been kept waiting */
+  for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+    if (class_queue[c].queued) {
+      int16_t rank = (int16_t)(c * TX_SCHEDULER_AGING_STEP) - class_queue[c].age;
+      if (rank < best_rank) {
+        best_rank = rank;
+        best = c;
+      }
+    }
+  }
+  if (best < TX_CLASS_COUNT) {
+    tx_class_queue_t *queue = &class_queue[best];
+    slot = queue->head;
+    queue->head = slots[slot].next;
+    if (SLOT_NONE == queue->head) {
+      queue->tail = SLOT_NONE;
+    }
+    queue->queued--;
+    queue->age = 0;
+    for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+      if ((c != best) && class_queue[c].queued && (class_queue[c].age < UINT8_MAX)) {
+        class_queue[c].age++;
+      }
+    }
+  }
+  taskEXIT_CRITICAL();
+  return slot;
+}
+
+uint8_t *tx_scheduler_frame(uint8_t slot)
+{
+  assert(slot < TX_SCHEDULER_SLOTS);
+  const tx_pool_info_t *pool = &pools[slot_pool(slot)];
+  return &pool->storage[(slot - pool->first) * pool->stride];
+}
+
+void tx_scheduler_release(uint8_t slot)
+{
+  assert(slot < TX_SCHEDULER_SLOTS);
+  taskENTER_CRITICAL();
+  tx_pool_t pool = slot_pool(slot);
+  class_queue[slots[slot].cls].allocated--;
+  slots[slot].next = free_head[pool];
+  free_head[pool] = slot;
+  taskEXIT_CRITICAL();
+}
+
+bool tx_scheduler_has_room(tx_class_t cls, uint8_t len)
+{
+  assert(cls < TX_CLASS_COUNT);
+  taskENTER_CRITICAL();
+  bool room = (class_queue[cls].allocated < class_depth[cls]) && (POOL_COUNT != pool_find(len));
+  taskEXIT_CRITICAL();
+  return room;
+}
+
+bool tx_scheduler_pending(void)
+{
+  for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+    if (class_queue[c].queued) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t tx_scheduler_dropped(tx_class_t cls)
+{
+  assert(cls < TX_CLASS_COUNT);
+  return class_queue[cls].dropped;
+}
+
+uint8_t tx_scheduler_high_water(tx_class_t cls)
+{
+  assert(cls < TX_CLASS_COUNT);
+  return class_queue[cls].high_water;
+}
+
+void tx_scheduler_stats_reset(void)
+{
+  taskENTER_CRITICAL();
+  for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+    class_queue[c].dropped = 0;
+    class_queue[c].high_water = class_queue[c].allocated;
+  }
+  taskEXIT_CRITICAL();
+}
@@ -0,0 +1,145 @@
+/**
+ * @file
+ * Priority scheduler for REQUEST frames transmitted to the host.
+ *
+ * Frames are queued per priority class. Each class has its own depth limit, so a burst in one
+ * class cannot use up the slots of another. The highest priority class with pending frames is
+ * served first, but every frame let past raises the age of the classes kept waiting. After
+ * TX_SCHEDULER_AGING_STEP frames a waiting class counts as one class higher, so lower classes are
+ * never starved.
+ *
+ * Frames are stored complete (see comm_interface_frame_build()) and transmitted straight from the
+ * slot. A slot stays allocated while its frame is in flight and is freed by tx_scheduler_release().
+ *
+ * Slots come from three pools of different size shared by all classes. A frame takes a slot from
+ * the smallest pool it fits in, or a larger one if that pool is empty. Most frames are callbacks
+ * of a few bytes, so this holds several times more frames than BUF_SIZE_TX sized slots would in
+ * the same RAM.
+ *
+ * @copyright 2022 Silicon Laboratories Inc.
+ */
+#ifndef _TX_SCHEDULER_H_
+#define _TX_SCHEDULER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Priority classes, highest priority first */
+typedef enum {
+  TX_CLASS_CALLBACK = 0,    ///< Completion callbacks of host requests (ZW_SendData etc.)
+  TX_CLASS_NODE_UPDATE,     ///< ApplicationControllerUpdate
+  TX_CLASS_APP_COMMAND,     ///< ApplicationCommandHandler and other unsolicited frames
+  TX_CLASS_COUNT
+} tx_class_t;
+
+/* Depth limits per class. Frames in flight count towards the limit of their class. */
+#if !defined(TX_SCHEDULER_DEPTH_CALLBACK)
+#define TX_SCHEDULER_DEPTH_CALLBACK     24
+#endif
+#if !defined(TX_SCHEDULER_DEPTH_NODE_UPDATE)
+#define TX_SCHEDULER_DEPTH_NODE_UPDATE  8
+#endif
+#if !defined(TX_SCHEDULER_DEPTH_APP_COMMAND)
+#define TX_SCHEDULER_DEPTH_APP_COMMAND  24
+#endif
+
+/* Slot pools: largest payload and number of slots. The large pool must hold BUF_SIZE_TX. */
+#if !defined(TX_SCHEDULER_SMALL_PAYLOAD)
+#define TX_SCHEDULER_SMALL_PAYLOAD      16
+#endif
+#if !defined(TX_SCHEDULER_SMALL_SLOTS)
+#define TX_SCHEDULER_SMALL_SLOTS        48
+#endif
+#if !defined(TX_SCHEDULER_MEDIUM_PAYLOAD)
+#define TX_SCHEDULER_MEDIUM_PAYLOAD     64
+#endif
+#if !defined(TX_SCHEDULER_MEDIUM_SLOTS)
+#define TX_SCHEDULER_MEDIUM_SLOTS       12
+#endif
+#if !defined(TX_SCHEDULER_LARGE_SLOTS)
+#define TX_SCHEDULER_LARGE_SLOTS        4
+#endif
+
+/* Number of frames a waiting class lets past before it is served as if it was one class higher */
+#if !defined(TX_SCHEDULER_AGING_STEP)
+#define TX_SCHEDULER_AGING_STEP         2
+#endif
+
+#define TX_SCHEDULER_SLOTS  (TX_SCHEDULER_SMALL_SLOTS    \
+                             + TX_SCHEDULER_MEDIUM_SLOTS \
+                             + TX_SCHEDULER_LARGE_SLOTS)
+
+/* Returned by tx_scheduler_next() when nothing is pending */
+#define TX_SCHEDULER_NONE   0xFF
+
+/**
+ * Empty all class queues. Dropped frame counters are cleared as well.
+ */
+void tx_scheduler_init(void);
+
+/**
+ * Queue a REQUEST frame.
+ *
+ * May be called from any task.
+ *
+ * @param cls Priority class
+ * @param cmd Function ID
+ * @param pData Payload, copied into the slot
+ * @param len Payload length, truncated to BUF_SIZE_TX
+ * @return false if the class is full or no slot is large enough. The frame is dropped and counted.
+ */
+bool tx_scheduler_enqueue(tx_class_t cls, uint8_t cmd, const uint8_t *pData, uint8_t len);
+
+/**
+ * Take the next frame to transmit out of its class queue.
+ *
+ * @return Slot of the frame, or TX_SCHEDULER_NONE if nothing is pending.
+ */
+uint8_t tx_scheduler_next(void);
+
+/**
+ * @param slot Slot returned by tx_scheduler_next()
+ * @return The complete frame held by @p slot.
+ */
+uint8_t *tx_scheduler_frame(uint8_t slot);
+
+/**
+ * Free a slot once its frame has been acknowledged or given up.
+ *
+ * @param slot Slot returned by tx_scheduler_next()
+ */
+void tx_scheduler_release(uint8_t slot);
+
+/**
+ * Check if tx_scheduler_enqueue() would accept a frame, without queuing anything.
+ *
+ * @param cls Priority class
+ * @param len Payload length
+ * @return true if @p cls is not full and a slot holding @p len bytes is free.
+ */
+bool tx_scheduler_has_room(tx_class_t cls, uint8_t len);
+
+/**
+ * @return true if at least one frame is waiting to be transmitted.
+ */
+bool tx_scheduler_pending(void);
+
+/**
+ * @param cls Priority class
+ * @return Number of frames dropped because @p cls was full.
+ */
+uint32_t tx_scheduler_dropped(tx_class_t cls);
+
+/**
+ * @param cls Priority class
+ * @return Most frames allocated in @p cls at once, queued and in flight.
+ */
+uint8_t tx_scheduler_high_water(tx_class_t cls);
+
+/**
+ * Clear the dropped frame counters and start the high-water marks over from the frames
+ * allocated now.
+ */
+void tx_scheduler_stats_reset(void);
+
+#endif /* _TX_SCHEDULER_H_ */
@@ -12,40 +12,122 @@
 
 static TaskHandle_t task_handle;
 
+/* Time GetCommandResponse() waits for the protocol to answer */
+#if !defined(COMMAND_RESPONSE_TIMEOUT_MS)
+#define COMMAND_RESPONSE_TIMEOUT_MS   1000
+#endif
+
+/* Statuses of other types GetCommandResponse() can hold while it waits */
+#if !defined(COMMAND_RESPONSE_STASH_SIZE)
+#define COMMAND_RESPONSE_STASH_SIZE   4
+#endif
+
+/* Only used by the application task, so it can be static instead of taking stack */
+static SZwaveCommandStatusPackage command_status_stash[COMMAND_RESPONSE_STASH_SIZE];
+
+static void NotifyCommandStatus(QueueHandle_t Queue)
+{
+  TaskHandle_t m_pAppTaskHandle = GetTaskHandle();
+  if (m_pAppTaskHandle && (0 < uxQueueMessagesWaiting(Queue))) {
+    /* Let the event distributor handle the statuses still in the queue */
+    __attribute__((unused)) BaseType_t Status = xTaskNotify(m_pAppTaskHandle, 1 << EAPPLICATIONEVENT_ZWCOMMANDSTATUS, eSetBits);
+    assert(Status == pdPASS); // We probably received a bad Task handle
+  }
+}
+
 uint8_t GetCommandResponse(SZwaveCommandStatusPackage *pCmdStatus, EZwaveCommandStatusType cmdType)
 {
   const SApplicationHandles * m_pAppHandles = ZAF_getAppHandle();
-  TaskHandle_t m_pAppTaskHandle = GetTaskHandle();
   QueueHandle_t Queue = m_pAppHandles->ZwCommandStatusQueue;
-  for (uint8_t delayCount = 0; delayCount < 100; delayCount++) {
-    for (UBaseType_t QueueElmCount = uxQueueMessagesWaiting(Queue); QueueElmCount > 0; QueueElmCount--) {
-      if (xQueueReceive(Queue, (uint8_t*)pCmdStatus, 0)) {
-        if (pCmdStatus->eStatusType == cmdType) {
-          if (m_pAppTaskHandle  && (0 < uxQueueMessagesWaiting(Queue))) {
-            /* More elements in queue call xTaskNotify */
-            __attribute__((unused)) BaseType_t Status = xTaskNotify(m_pAppTaskHandle, 1 << EAPPLICATIONEVENT_ZWCOMMANDSTATUS, eSetBits);
-            assert(Status == pdPASS); // We probably received a bad Task handle
-          }
-          return true;
-        } else {
-          /* Re-insert none-matching message into Queue */
-          __attribute__((unused)) BaseType_t result = xQueueSendToBack(Queue, (uint8_t*)pCmdStatus, 0);
-          assert(pdTRUE == result);
-        }
+  /* The protocol notifies the application task when it puts a status on the queue */
+  const bool notified = (xTaskGetCurrentTaskHandle() == GetTaskHandle());
+  const TickType_t timeout = pdMS_TO_TICKS(COMMAND_RESPONSE_TIMEOUT_MS);
+  const TickType_t start = xTaskGetTickCount();
+  uint8_t stashed = 0;
+  bool found = false;
+  uint32_t other_events = 0;
+
+  for (;;) {
+    /* Take statuses off the queue in order until the wanted one. The others are held in the stash. */
+    for (UBaseType_t QueueElmCount = uxQueueMessagesWaiting(Queue); (QueueElmCount > 0) && !found; QueueElmCount--) {
+      if (!xQueueReceive(Queue, (uint8_t*)pCmdStatus, 0)) {
+        break;
       }
+      if (pCmdStatus->eStatusType == cmdType) {
+        found = true;
+      } else if (stashed < COMMAND_RESPONSE_STASH_SIZE) {
+        command_status_stash[stashed++] = *pCmdStatus;
+      } else {
+        /* Stash is full, put it back at the end of the queue */
+        __attribute__((unused)) BaseType_t result = xQueueSendToBack(Queue, (uint8_t*)pCmdStatus, 0);
+        assert(pdTRUE == result);
+      }
+    }
+
+    const TickType_t elapsed = xTaskGetTickCount() - start;
+    if (found || (elapsed >= timeout)) {
+      break;
+    }
+    if (notified) {
+      /* Wake up on the next status. The wait also returns on, and clears the pending state of, any
+         other event, which is posted again below so the event distributor is woken up for it. */
+      uint32_t events = 0;
+      xTaskNotifyWait(0, 1 << EAPPLICATIONEVENT_ZWCOMMANDSTATUS, &events, timeout - elapsed);
+      other_events |= events & ~(1UL << EAPPLICATIONEVENT_ZWCOMMANDSTATUS);
+    } else {
+      vTaskDelay(1);
     }
-    vTaskDelay(10);
   }
-  if (m_pAppTaskHandle && (0 < uxQueueMessagesWaiting(Queue))) {
-    /* Only call xTaskNotify if still elements in queue */
-    __attribute__((unused)) BaseType_t Status = xTaskNotify(m_pAppTaskHandle, 1 << EAPPLICATIONEVENT_ZWCOMMANDSTATUS, eSetBits);
-    assert(Status == pdPASS); // We probably received a bad Task handle
+
+  /* Return the stashed statuses to the front of the queue in the order they were received */
+  while (stashed > 0) {
+    __attribute__((unused)) BaseType_t result = xQueueSendToFront(Queue, (uint8_t*)&command_status_stash[--stashed], 0);
+    assert(pdTRUE == result);
+  }
+  NotifyCommandStatus(Queue);
+  if (other_events) {
+    __attribute__((unused)) BaseType_t Status = xTaskNotify(GetTaskHandle(), other_events, eSetBits);
+    assert(Status == pdPASS);
   }
-  return false;
+  return found;
+}
+
+/* Items of node_list_cache holding what the protocol returned */
+#define CACHED_PRIMARY        0x01
+#define CACHED_CAPABILITIES   0x02
+#define CACHED_NODES          0x04
+#define CACHED_LR_NODES       0x08
+#define CACHED_NLS_NODES(page) (0x10 << (page))
+
+#define NLS_NODES_PAGES  ((MAX_NODEMASK_LENGTH + MAX_LR_NODEMASK_LENGTH + GET_NLS_NODES_LIST_LENGTH_MAX - 1) / GET_NLS_NODES_LIST_LENGTH_MAX)
+
+_Static_assert(NLS_NODES_PAGES <= 4, "STATIC_ASSERT_NLS_NODES_PAGES_to_big");
+
+/* Snapshot of the network membership, which the host reads on every reconnect.
+   Filled on first use and emptied by NodeListCacheInvalidate(). Only used by the application task. */
+static struct {
+  uint8_t cached;
+  uint8_t is_primary;
+  uint8_t capabilities;
+  NODE_MASK_TYPE nodes;
+  LR_NODE_MASK_TYPE lr_nodes;
+  struct {
+    bool more_nodes;
+    uint8_t output_length;
+    uint8_t node_id_list[GET_NLS_NODES_LIST_LENGTH_MAX];
+  } nls_nodes[NLS_NODES_PAGES];
+} node_list_cache;
+
+void NodeListCacheInvalidate(void)
+{
+  node_list_cache.cached = 0;
 }
 
 uint8_t IsPrimaryController(void)
 {
+  if (node_list_cache.cached & CACHED_PRIMARY) {
+    return node_list_cache.is_primary;
+  }
   const SApplicationHandles *m_pAppHandles = ZAF_getAppHandle();
   SZwaveCommandPackage cmdPackage = {
     .eCommandType = EZWAVECOMMANDTYPE_IS_PRIMARY_CTRL
@@ -54,7 +136,9 @@ uint8_t IsPrimaryController(void)
   assert(EQUEUENOTIFYING_STATUS_SUCCESS == QueueStatus);
   SZwaveCommandStatusPackage cmdStatus = { 0 };
   if (GetCommandResponse(&cmdStatus, EZWAVECOMMANDSTATUS_IS_PRIMARY_CTRL)) {
-    return cmdStatus.Content.IsPrimaryCtrlStatus.result;
+    node_list_cache.is_primary = cmdStatus.Content.IsPrimaryCtrlStatus.result;
+    node_list_cache.cached |= CACHED_PRIMARY;
+    return node_list_cache.is_primary;
   }
   assert(false);
   return 0;
@@ -62,6 +146,9 @@ uint8_t IsPrimaryController(void)
 
 uint8_t GetControllerCapabilities(void)
 {
+  if (node_list_cache.cached & CACHED_CAPABILITIES) {
+    return node_list_cache.capabilities;
+  }
   const SApplicationHandles *m_pAppHandles = ZAF_getAppHandle();
   SZwaveCommandPackage cmdPackage = {
     .eCommandType = EZWAVECOMMANDTYPE_GET_CONTROLLER_CAPABILITIES
@@ -71,7 +158,9 @@ uint8_t GetControllerCapabilities(void)
   SZwaveCommandStatusPackage cmdStatus = { .eStatusType = EZWAVECOMMANDSTATUS_GET_CONTROLLER_CAPABILITIES };
   if (GetCommandResponse(&cmdStatus, cmdStatus.eStatusType)) {
     ZPAL_LOG_DEBUG(ZPAL_LOG_APP, "%s: Controller capabilities byte = 0x%02X\r\n", __FUNCTION__, cmdStatus.Content.GetControllerCapabilitiesStatus.result);
-    return cmdStatus.Content.GetControllerCapabilitiesStatus.result;
+    node_list_cache.capabilities = cmdStatus.Content.GetControllerCapabilitiesStatus.result;
+    node_list_cache.cached |= CACHED_CAPABILITIES;
+    return node_list_cache.capabilities;
   }
   assert(false);
   return 0;
@@ -133,10 +222,16 @@ void GetNodeInfo(uint16_t NodeId, t_ExtNodeInfo* pNodeInfo)
  * Method requires CommandQueue to protocol to be empty.
  * Method will cause assert on failure.
  *
+ * Answered from RAM until NodeListCacheInvalidate() is called.
+ *
  * @param[out]    node_id_list    Pointer to bitmask list where aquired included nodes IDs saved
  */
 void Get_included_nodes(uint8_t* node_id_list)
 {
+  if (node_list_cache.cached & CACHED_NODES) {
+    memcpy(node_id_list, node_list_cache.nodes, sizeof(NODE_MASK_TYPE));
+    return;
+  }
   const SApplicationHandles *m_pAppHandles = ZAF_getAppHandle();
   SZwaveCommandPackage GetIncludedNodesCommand = {
     .eCommandType = EZWAVECOMMANDTYPE_ZW_GET_INCLUDED_NODES
@@ -148,7 +243,9 @@ void Get_included_nodes(uint8_t* node_id_list)
   // Wait for protocol to handle command (it shouldnt take long)
   SZwaveCommandStatusPackage includedNodes = { .eStatusType = EZWAVECOMMANDSTATUS_ZW_GET_INCLUDED_NODES };
   if (GetCommandResponse(&includedNodes, includedNodes.eStatusType)) {
-    memcpy(node_id_list, (uint8_t*)includedNodes.Content.GetIncludedNodes.node_id_list, sizeof(NODE_MASK_TYPE));
+    memcpy(node_list_cache.nodes, (uint8_t*)includedNodes.Content.GetIncludedNodes.node_id_list, sizeof(NODE_MASK_TYPE));
+    node_list_cache.cached |= CACHED_NODES;
+    memcpy(node_id_list, node_list_cache.nodes, sizeof(NODE_MASK_TYPE));
     return;
   }
   assert(false);
@@ -161,9 +258,18 @@ void Get_included_nodes(uint8_t* node_id_list)
  * @param[in]  bitmask_offset    Nodes ID offset represented in multiples of 128 bytes
  * @param[out] more_nodes        Flag indicating that there still exist nodes to be queried
  * @param[out] output_length     Pointer to output length of the nodes ID list
+ *
+ * Answered from RAM until NodeListCacheInvalidate() is called.
  */
 void Get_included_NLS_nodes(uint8_t * const node_id_list, uint8_t bitmask_offset, bool * const more_nodes, uint8_t * const output_length)
 {
+  const bool cacheable = (bitmask_offset < NLS_NODES_PAGES);
+  if (cacheable && (node_list_cache.cached & CACHED_NLS_NODES(bitmask_offset))) {
+    memcpy((void *)node_id_list, node_list_cache.nls_nodes[bitmask_offset].node_id_list, GET_NLS_NODES_LIST_LENGTH_MAX);
+    *more_nodes = node_list_cache.nls_nodes[bitmask_offset].more_nodes;
+    *output_length = node_list_cache.nls_nodes[bitmask_offset].output_length;
+    return;
+  }
   const SApplicationHandles * m_pAppHandles = ZAF_getAppHandle();
   SZwaveCommandPackage GetIncludedNodesCommand = {
     .eCommandType = EZWAVECOMMANDTYPE_ZW_GET_INCLUDED_NLS_NODES,
@@ -181,6 +287,12 @@ void Get_included_NLS_nodes(uint8_t * const node_id_list, uint8_t bitmask_offset
     memcpy((void *)node_id_list, (uint8_t*)includedNodes.Content.GetIncludedNodesNLS.node_id_list, GET_NLS_NODES_LIST_LENGTH_MAX);
     *more_nodes = includedNodes.Content.GetIncludedNodesNLS.more_nodes;
     *output_length = includedNodes.Content.GetIncludedNodesNLS.output_length;
+    if (cacheable) {
+      memcpy(node_list_cache.nls_nodes[bitmask_offset].node_id_list, (void *)node_id_list, GET_NLS_NODES_LIST_LENGTH_MAX);
+      node_list_cache.nls_nodes[bitmask_offset].more_nodes = *more_nodes;
+      node_list_cache.nls_nodes[bitmask_offset].output_length = *output_length;
+      node_list_cache.cached |= CACHED_NLS_NODES(bitmask_offset);
+    }
     return;
   }
   assert(false);
@@ -193,10 +305,16 @@ void Get_included_NLS_nodes(uint8_t * const node_id_list, uint8_t bitmask_offset
  * Method requires CommandQueue to protocol to be empty.
  * Method will cause assert on failure.
  *
+ * Answered from RAM until NodeListCacheInvalidate() is called.
+ *
  * @param[out]    node_id_list    Pointer to bitmask list where aquired included nodes IDs saved
  */
 void Get_included_lr_nodes(uint8_t* node_id_list)
 {
+  if (node_list_cache.cached & CACHED_LR_NODES) {
+    memcpy(node_id_list, node_list_cache.lr_nodes, sizeof(LR_NODE_MASK_TYPE));
+    return;
+  }
   const SApplicationHandles * m_pAppHandles = ZAF_getAppHandle();
   SZwaveCommandPackage GetIncludedNodesCommand = {
     .eCommandType = EZWAVECOMMANDTYPE_ZW_GET_INCLUDED_LR_NODES
@@ -208,7 +326,9 @@ void Get_included_lr_nodes(uint8_t* node_id_list)
   // Wait for protocol to handle command (it shouldn't take long)
   SZwaveCommandStatusPackage includedNodes = { 0 };
   if (GetCommandResponse(&includedNodes, EZWAVECOMMANDSTATUS_ZW_GET_INCLUDED_LR_NODES)) {
-    memcpy(node_id_list, (uint8_t*)includedNodes.Content.GetIncludedNodesLR.node_id_list, sizeof(LR_NODE_MASK_TYPE));
+    memcpy(node_list_cache.lr_nodes, (uint8_t*)includedNodes.Content.GetIncludedNodesLR.node_id_list, sizeof(LR_NODE_MASK_TYPE));
+    node_list_cache.cached |= CACHED_LR_NODES;
+    memcpy(node_id_list, node_list_cache.lr_nodes, sizeof(LR_NODE_MASK_TYPE));
     return;
   }
   assert(false);
@@ -15,10 +15,30 @@ static inline uint32_t ceiling_division(uint32_t x, uint32_t y)
   return ((x) + (y) - 1) / (y);
 }
 
+/**
+ * Store a 32 bit value MSB first, as in SerialAPI frames.
+ *
+ * @return Number of bytes written.
+ */
+static inline uint8_t put_32bit_value(uint8_t *pData, uint32_t value)
+{
+  pData[0] = (uint8_t)(value >> 24);
+  pData[1] = (uint8_t)(value >> 16);
+  pData[2] = (uint8_t)(value >> 8);
+  pData[3] = (uint8_t)value;
+  return 4;
+}
+
 uint8_t QueueProtocolCommand(uint8_t *pCommand);
 
 uint8_t GetCommandResponse(SZwaveCommandStatusPackage *pCmdStatus, EZwaveCommandStatusType cmdType);
 
+/**
+ * Forget the controller flags and node lists kept by IsPrimaryController(), GetControllerCapabilities()
+ * and the Get_included_*() functions. Must be called when the network membership may have changed.
+ */
+void NodeListCacheInvalidate(void);
+
 uint8_t IsPrimaryController(void);
 
 uint8_t GetControllerCapabilities(void);